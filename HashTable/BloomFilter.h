@@ -0,0 +1,268 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+#include "Set.h"
+
+/// <summary>
+/// Блочный фильтр Блума - вероятностное множество для быстрой отсечки отсутствующих элементов.
+/// Отвечает "точно нет" или "возможно есть" (ложноположительные ответы с заданной вероятностью,
+/// ложноотрицательных не бывает). Занимает около 10 бит на элемент при 1% ошибок,
+/// вместо хранения самих элементов.
+/// Все k битов элемента лежат в одном блоке размером с кеш-линию (512 бит), поэтому
+/// вставка и проверка трогают одну кеш-линию. Проверка собирает маску для 8 слов блока
+/// и сравнивает все слова разом, без ветвлений по отдельным битам.
+/// </summary>
+/// <typeparam name="T">Тип элемента</typeparam>
+template <typename T>
+class BloomFilter {
+private:
+    static const size_t wordsPerBlock = 8; // 8 * 64 бит = 512 бит = одна кеш-линия
+    static const uint32_t magic = 0x314D4C42; // "BLM1" - метка формата сериализации
+    static const uint32_t maxHashCount = 16; // Наибольшее k
+    static constexpr size_t readChunkBlocks = 16384; // Блоков за одно чтение в deserialize (1 МБ)
+
+    /// <summary>
+    /// Блок фильтра, выровненный по кеш-линии.
+    /// </summary>
+    struct alignas(64) Block {
+        uint64_t words[wordsPerBlock];
+    };
+
+    std::vector<Block> blocks; // Блоки фильтра
+    uint32_t hashCount; // Количество битов на элемент (k)
+
+    /// <summary>
+    /// Выбирает блок и строит маску из k битов элемента внутри блока.
+    /// Позиции битов - двойное хеширование (a + i * b) mod 512 с нечётным b, поэтому все k позиций различны.
+    /// </summary>
+    size_t locate(const T& key, uint64_t (&mask)[wordsPerBlock]) const {
+        uint64_t hash = keyHash64<T>(key);
+        size_t block = static_cast<size_t>((hash >> 32) % blocks.size());
+        uint64_t inner = mix64(hash ^ 0x9e3779b97f4a7c15ULL);
+        uint32_t position = static_cast<uint32_t>(inner & 511);
+        uint32_t step = static_cast<uint32_t>((inner >> 9) & 511) | 1;
+
+        for (size_t w = 0; w < wordsPerBlock; ++w) {
+            mask[w] = 0;
+        }
+        for (uint32_t i = 0; i < hashCount; ++i) {
+            mask[position >> 6] |= uint64_t(1) << (position & 63);
+            position = (position + step) & 511;
+        }
+        return block;
+    }
+
+    BloomFilter() : hashCount(1) {}
+
+public:
+    /// <summary>
+    /// Конструктор фильтра под ожидаемое число элементов и желаемую долю ложноположительных ответов.
+    /// Размер: m = -n ln p / (ln 2)^2 бит, k = m / n * ln 2 (от 1 до 16).
+    /// </summary>
+    /// <param name="expectedItems">Ожидаемое количество элементов.</param>
+    /// <param name="falsePositiveRate">Желаемая вероятность ложноположительного ответа (например, 0.01).</param>
+    BloomFilter(size_t expectedItems, double falsePositiveRate = 0.01) {
+        if (falsePositiveRate <= 0 || falsePositiveRate >= 1) {
+            throw std::invalid_argument("False positive rate must be in (0, 1)");
+        }
+        double n = static_cast<double>(std::max<size_t>(expectedItems, 1));
+        double ln2 = std::log(2.0);
+        double bits = -n * std::log(falsePositiveRate) / (ln2 * ln2);
+        size_t blockCount = static_cast<size_t>(std::ceil(bits / (wordsPerBlock * 64)));
+        blocks.assign(std::max<size_t>(blockCount, 1), Block());
+        double k = std::round(bits / n * ln2);
+        hashCount = static_cast<uint32_t>(std::min(static_cast<double>(maxHashCount), std::max(1.0, k)));
+    }
+
+    /// <summary>
+    /// Строит фильтр по содержимому множества.
+    /// </summary>
+    /// <param name="set">Множество, элементы которого добавляются в фильтр.</param>
+    /// <param name="falsePositiveRate">Желаемая вероятность ложноположительного ответа.</param>
+    BloomFilter(const Set<T>& set, double falsePositiveRate = 0.01)
+        : BloomFilter(set.size(), falsePositiveRate) {
+        set.forEach([this](const T& value) {
+            insert(value);
+        });
+    }
+
+    /// <summary>
+    /// Добавляет элемент в фильтр.
+    /// BigO: O(k), одна кеш-линия
+    /// </summary>
+    void insert(const T& key) {
+        uint64_t mask[wordsPerBlock];
+        Block& block = blocks[locate(key, mask)];
+        for (size_t w = 0; w < wordsPerBlock; ++w) {
+            block.words[w] |= mask[w];
+        }
+    }
+
+    /// <summary>
+    /// Проверяет, может ли элемент быть в фильтре.
+    /// BigO: O(k), одна кеш-линия
+    /// </summary>
+    /// <returns>false - элемента точно нет; true - элемент возможно есть.</returns>
+    bool contains(const T& key) const {
+        uint64_t mask[wordsPerBlock];
+        const Block& block = blocks[locate(key, mask)];
+        uint64_t missing = 0;
+        for (size_t w = 0; w < wordsPerBlock; ++w) {
+            missing |= mask[w] & ~block.words[w];
+        }
+        return missing == 0;
+    }
+
+    /// <summary>
+    /// Объединяет с другим фильтром той же конфигурации (побитовое ИЛИ).
+    /// После объединения фильтр отвечает "возможно есть" на элементы обоих фильтров.
+    /// </summary>
+    void merge(const BloomFilter& other) {
+        if (blocks.size() != other.blocks.size() || hashCount != other.hashCount) {
+            throw std::invalid_argument("Bloom filters have different configuration");
+        }
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            for (size_t w = 0; w < wordsPerBlock; ++w) {
+                blocks[b].words[w] |= other.blocks[b].words[w];
+            }
+        }
+    }
+
+    void clear() {
+        blocks.assign(blocks.size(), Block());
+    }
+
+    uint32_t get_hashCount() const {
+        return hashCount;
+    }
+
+    size_t sizeInBytes() const {
+        return blocks.size() * sizeof(Block);
+    }
+
+    /// <summary>
+    /// Записывает фильтр в поток в двоичном виде (порядок байтов платформы).
+    /// Хеш строится на std::hash, поэтому файл читается той же сборкой программы.
+    /// </summary>
+    void serialize(std::ostream& out) const {
+        uint32_t header[2] = { magic, hashCount };
+        uint64_t blockCount = blocks.size();
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&blockCount), sizeof(blockCount));
+        out.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size() * sizeof(Block)));
+    }
+
+    /// <summary>
+    /// Читает фильтр, записанный serialize.
+    /// Если формат не совпадает, будет сгенерировано исключение runtime_error.
+    /// Блоки читаются порциями по readChunkBlocks: повреждённое количество блоков в заголовке
+    /// обрывается на конце потока, а не выделяет память под всё заявленное количество.
+    /// </summary>
+    static BloomFilter deserialize(std::istream& in) {
+        uint32_t header[2] = { 0, 0 };
+        uint64_t blockCount = 0;
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        in.read(reinterpret_cast<char*>(&blockCount), sizeof(blockCount));
+        if (!in || header[0] != magic || header[1] == 0 || header[1] > maxHashCount
+            || blockCount == 0 || blockCount > SIZE_MAX / sizeof(Block)) {
+            throw std::runtime_error("Invalid Bloom filter data");
+        }
+
+        BloomFilter filter;
+        filter.hashCount = header[1];
+        filter.blocks.clear();
+        while (filter.blocks.size() < blockCount) {
+            size_t begin = filter.blocks.size();
+            size_t step = static_cast<size_t>(std::min<uint64_t>(readChunkBlocks, blockCount - begin));
+            filter.blocks.resize(begin + step);
+            in.read(reinterpret_cast<char*>(filter.blocks.data() + begin), static_cast<std::streamsize>(step * sizeof(Block)));
+            if (!in) {
+                throw std::runtime_error("Invalid Bloom filter data");
+            }
+        }
+        return filter;
+    }
+
+    /// <summary>
+    /// Функция для тестирования BloomFilter
+    /// </summary>
+    static void testBloomFilter() {
+        const int n = 20000;
+        BloomFilter<int> filter(n, 0.01);
+        for (int i = 0; i < n; ++i) {
+            filter.insert(i);
+        }
+
+        // Ложноотрицательных ответов нет
+        for (int i = 0; i < n; ++i) {
+            assert(filter.contains(i));
+        }
+
+        // Доля ложноположительных близка к заданной
+        int falsePositives = 0;
+        for (int i = n; i < 3 * n; ++i) {
+            if (filter.contains(i)) {
+                falsePositives++;
+            }
+        }
+        assert(falsePositives < 2 * n * 0.02);
+
+        // Объединение
+        BloomFilter<int> other(n, 0.01);
+        other.insert(-7);
+        filter.merge(other);
+        assert(filter.contains(-7) && filter.contains(0));
+
+        BloomFilter<int> different(10 * n, 0.01);
+        try {
+            filter.merge(different);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+
+        // Сериализация
+        std::stringstream buffer;
+        filter.serialize(buffer);
+        BloomFilter<int> restored = BloomFilter<int>::deserialize(buffer);
+        for (int i = 0; i < 3 * n; ++i) {
+            assert(restored.contains(i) == filter.contains(i));
+        }
+
+        // Повреждённые заголовки: k больше 16 и огромное количество блоков без данных
+        for (uint64_t corrupt : { uint64_t(0), uint64_t(1) }) {
+            std::stringstream broken;
+            uint32_t header[2] = { magic, corrupt == 0 ? 17u : 4u };
+            uint64_t blockCount = corrupt == 0 ? 1 : uint64_t(1) << 40;
+            broken.write(reinterpret_cast<const char*>(header), sizeof(header));
+            broken.write(reinterpret_cast<const char*>(&blockCount), sizeof(blockCount));
+            broken.write(reinterpret_cast<const char*>(filter.blocks.data()), sizeof(Block));
+            try {
+                BloomFilter<int>::deserialize(broken);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+        }
+
+        // Построение по множеству строк
+        Set<std::string> words;
+        words.insert("hello");
+        words.insert("world");
+        BloomFilter<std::string> wordFilter(words, 0.001);
+        assert(wordFilter.contains("hello") && wordFilter.contains("world"));
+
+        std::cout << "All BLOOM FILTER tests passed!" << std::endl;
+    }
+};
@@ -0,0 +1,443 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+
+/// <summary>
+/// Компактный словарь, сохраняющий порядок вставки.
+/// Пары хранятся в плотном непрерывном массиве записей (хеш, ключ, значение) в порядке вставки,
+/// а поиск идёт через отдельную небольшую таблицу индексов (открытая адресация, линейное
+/// пробирование), в ячейках которой лежат номера записей. Ширина ячейки - 1, 2 или 4 байта
+/// в зависимости от ёмкости, поэтому при небольших размерах таблица индексов занимает
+/// единицы байт на элемент.
+/// Обход - линейный проход по массиву записей, без узлов std::list, и порядок обхода
+/// детерминирован (порядок вставки), в отличие от Dictionary, где он зависит от хешей.
+/// Удалённые записи помечаются и вычищаются при следующей перестройке индекса.
+/// </summary>
+/// <typeparam name="Key">Тип ключа</typeparam>
+/// <typeparam name="Value">Тип значения</typeparam>
+template <typename Key, typename Value>
+class CompactDictionary {
+private:
+    /// <summary>
+    /// Запись словаря. Хеш хранится, чтобы не пересчитывать его при перестройке индекса
+    /// и отсекать несовпадающие ключи без сравнения.
+    /// </summary>
+    struct Entry {
+        size_t hash;
+        std::pair<Key, Value> item;
+        bool removed;
+    };
+
+    std::vector<Entry> entries; // Записи в порядке вставки (включая удалённые)
+    std::vector<uint8_t> index; // Таблица индексов: slotCount ячеек по width байт
+    size_t slotCount; // Количество ячеек индекса (степень двойки)
+    size_t width; // Ширина ячейки индекса в байтах: 1, 2 или 4
+    size_t liveCount; // Количество неудалённых записей
+
+    // Значения ячеек индекса: 0 - пусто, dummy() - удалённая запись, иначе номер записи + 1
+
+    uint32_t dummy() const {
+        return width == 1 ? 0xFF : width == 2 ? 0xFFFF : 0xFFFFFFFF;
+    }
+
+    /// <summary>
+    /// Сколько записей (вместе с удалёнными) помещается при данном числе ячеек - загрузка 2/3.
+    /// </summary>
+    static size_t usableFor(size_t slots) {
+        return slots * 2 / 3;
+    }
+
+    static size_t widthFor(size_t slots) {
+        size_t usable = usableFor(slots);
+        return usable < 0xFE ? 1 : usable < 0xFFFE ? 2 : 4;
+    }
+
+    uint32_t readSlot(size_t slot) const {
+        const uint8_t* cell = index.data() + slot * width;
+        if (width == 1) {
+            return *cell;
+        }
+        if (width == 2) {
+            uint16_t value;
+            std::memcpy(&value, cell, sizeof(value));
+            return value;
+        }
+        uint32_t value;
+        std::memcpy(&value, cell, sizeof(value));
+        return value;
+    }
+
+    void writeSlot(size_t slot, uint32_t value) {
+        uint8_t* cell = index.data() + slot * width;
+        if (width == 1) {
+            *cell = static_cast<uint8_t>(value);
+        }
+        else if (width == 2) {
+            uint16_t narrow = static_cast<uint16_t>(value);
+            std::memcpy(cell, &narrow, sizeof(narrow));
+        }
+        else {
+            std::memcpy(cell, &value, sizeof(value));
+        }
+    }
+
+    size_t homeSlot(size_t hash) const {
+        return static_cast<size_t>(mix64(hash)) & (slotCount - 1);
+    }
+
+    /// <summary>
+    /// Ищет ячейку индекса с ключом.
+    /// </summary>
+    /// <returns>Номер ячейки или slotCount, если ключа нет.</returns>
+    size_t findSlot(const Key& key, size_t hash) const {
+        const uint32_t removedMark = dummy();
+        for (size_t slot = homeSlot(hash);; slot = (slot + 1) & (slotCount - 1)) {
+            uint32_t value = readSlot(slot);
+            if (value == 0) {
+                return slotCount;
+            }
+            if (value != removedMark) {
+                const Entry& entry = entries[value - 1];
+                if (entry.hash == hash && entry.item.first == key) {
+                    return slot;
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Первая свободная ячейка (пустая или удалённая) на пути пробирования хеша.
+    /// </summary>
+    size_t freeSlot(size_t hash) const {
+        const uint32_t removedMark = dummy();
+        size_t slot = homeSlot(hash);
+        while (true) {
+            uint32_t value = readSlot(slot);
+            if (value == 0 || value == removedMark) {
+                return slot;
+            }
+            slot = (slot + 1) & (slotCount - 1);
+        }
+    }
+
+    /// <summary>
+    /// Вычищает удалённые записи (с сохранением порядка) и строит индекс заново на slots ячеек.
+    /// BigO: O(n)
+    /// </summary>
+    void rebuild(size_t slots) {
+        if (liveCount != entries.size()) {
+            size_t out = 0;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (!entries[i].removed) {
+                    if (out != i) {
+                        entries[out] = std::move(entries[i]);
+                    }
+                    out++;
+                }
+            }
+            entries.erase(entries.begin() + out, entries.end());
+        }
+
+        slotCount = slots;
+        width = widthFor(slots);
+        index.assign(slotCount * width, 0);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            writeSlot(freeSlot(entries[i].hash), static_cast<uint32_t>(i + 1));
+        }
+        entries.reserve(usableFor(slotCount));
+    }
+
+    /// <summary>
+    /// Освобождает место под ещё одну запись: если удалённых записей много, достаточно
+    /// их вычистить, иначе индекс удваивается.
+    /// </summary>
+    void makeRoom() {
+        if (entries.size() < usableFor(slotCount)) {
+            return;
+        }
+        rebuild(liveCount < entries.size() / 2 ? slotCount : slotCount * 2);
+    }
+
+    Entry* findEntry(const Key& key) {
+        size_t slot = findSlot(key, fnv1aHash<Key>(key));
+        return slot == slotCount ? nullptr : &entries[readSlot(slot) - 1];
+    }
+
+    const Entry* findEntry(const Key& key) const {
+        size_t slot = findSlot(key, fnv1aHash<Key>(key));
+        return slot == slotCount ? nullptr : &entries[readSlot(slot) - 1];
+    }
+
+public:
+    /// <summary>
+    /// Конструктор словаря.
+    /// </summary>
+    /// <param name="capacity">Ожидаемое количество пар.</param>
+    CompactDictionary(size_t capacity = 0) : slotCount(8), width(1), liveCount(0) {
+        while (usableFor(slotCount) < capacity) {
+            slotCount <<= 1;
+        }
+        rebuild(slotCount);
+    }
+
+    /// <summary>
+    /// Вставка пары (ключ, значение) в конец порядка обхода.
+    /// Если ключ уже существует, обновляет значение, не меняя его место в порядке.
+    /// </summary>
+    /// <returns>true, если пара была вставлена.</returns>
+    /// <BigO>Среднее : O(1)</BigO>
+    bool put(const Key& key, const Value& value) {
+        size_t hash = fnv1aHash<Key>(key);
+        size_t slot = findSlot(key, hash);
+        if (slot != slotCount) {
+            entries[readSlot(slot) - 1].item.second = value;
+            return false;
+        }
+        makeRoom();
+        entries.push_back(Entry{ hash, std::pair<Key, Value>(key, value), false });
+        writeSlot(freeSlot(hash), static_cast<uint32_t>(entries.size()));
+        liveCount++;
+        return true;
+    }
+
+    /// <summary>
+    /// Доступ к значению по ключу; если ключа нет, в конец вставляется значение по умолчанию.
+    /// Ссылка действительна до следующей вставки.
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    Value& operator[](const Key& key) {
+        Entry* existing = findEntry(key);
+        if (existing != nullptr) {
+            return existing->item.second;
+        }
+        put(key, Value());
+        return entries.back().item.second;
+    }
+
+    /// <summary>
+    /// Получение значения по ключу.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    Value get(const Key& key) const {
+        const Entry* existing = findEntry(key);
+        if (existing == nullptr) {
+            throw std::runtime_error("Key not found");
+        }
+        return existing->item.second;
+    }
+
+    /// <summary>
+    /// Поиск значения по ключу без копирования.
+    /// </summary>
+    /// <returns>Указатель на значение или nullptr. Действителен до следующей вставки.</returns>
+    Value* find(const Key& key) {
+        Entry* existing = findEntry(key);
+        return existing == nullptr ? nullptr : &existing->item.second;
+    }
+
+    const Value* find(const Key& key) const {
+        const Entry* existing = findEntry(key);
+        return existing == nullptr ? nullptr : &existing->item.second;
+    }
+
+    bool contains(const Key& key) const {
+        return findEntry(key) != nullptr;
+    }
+
+    /// <summary>
+    /// Удаление пары по ключу. Запись помечается удалённой, место в массиве освобождается
+    /// при следующей перестройке.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    void remove(const Key& key) {
+        size_t slot = findSlot(key, fnv1aHash<Key>(key));
+        if (slot == slotCount) {
+            throw std::runtime_error("Key not found");
+        }
+        entries[readSlot(slot) - 1].removed = true;
+        writeSlot(slot, dummy());
+        liveCount--;
+    }
+
+    size_t size() const {
+        return liveCount;
+    }
+
+    void clear() {
+        entries.clear();
+        liveCount = 0;
+        rebuild(8);
+    }
+
+    /// <summary>
+    /// Резервирует место под n пар без перестроек индекса.
+    /// </summary>
+    void reserve(size_t n) {
+        size_t slots = slotCount;
+        while (usableFor(slots) < n) {
+            slots <<= 1;
+        }
+        if (slots != slotCount) {
+            rebuild(slots);
+        }
+    }
+
+    /// <summary>
+    /// Ширина ячейки таблицы индексов в байтах (1, 2 или 4).
+    /// </summary>
+    size_t indexWidth() const {
+        return width;
+    }
+
+    /// <summary>
+    /// Примерный объём памяти словаря: массив записей и таблица индексов.
+    /// </summary>
+    size_t sizeInBytes() const {
+        return entries.capacity() * sizeof(Entry) + index.capacity();
+    }
+
+    /// <summary>
+    /// Обходит пары в порядке вставки.
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const Entry& entry : entries) {
+            if (!entry.removed) {
+                visit(entry.item.first, entry.item.second);
+            }
+        }
+    }
+
+    // Итератор для CompactDictionary: обход в порядке вставки
+    class Iterator {
+    private:
+        const Entry* current; // Текущая запись
+        const Entry* last; // Запись за последней
+
+        void skipRemoved() {
+            while (current != last && current->removed) {
+                ++current;
+            }
+        }
+
+    public:
+        Iterator(const Entry* start, const Entry* last) : current(start), last(last) {
+            skipRemoved();
+        }
+
+        const std::pair<Key, Value>& operator*() const {
+            return current->item;
+        }
+
+        Iterator& operator++() {
+            ++current;
+            skipRemoved();
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return current != other.current;
+        }
+    };
+
+    Iterator begin() const {
+        return Iterator(entries.data(), entries.data() + entries.size());
+    }
+
+    Iterator end() const {
+        return Iterator(entries.data() + entries.size(), entries.data() + entries.size());
+    }
+
+    /// <summary>
+    /// Функция для тестирования CompactDictionary
+    /// </summary>
+    static void testCompactDictionary() {
+        CompactDictionary<std::string, int> dict;
+        assert(dict.size() == 0);
+        assert(dict.put("banana", 2));
+        assert(dict.put("apple", 1));
+        assert(dict.put("orange", 3));
+        assert(!dict.put("banana", 5)); // Обновление не меняет порядок
+        assert(dict.get("banana") == 5);
+
+        // Порядок обхода - порядок вставки
+        std::vector<std::string> order;
+        for (const auto& pair : dict) {
+            order.push_back(pair.first);
+        }
+        assert((order == std::vector<std::string>{ "banana", "apple", "orange" }));
+
+        // Повторная вставка после удаления попадает в конец
+        dict.remove("banana");
+        assert(!dict.contains("banana"));
+        try {
+            dict.get("banana");
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        try {
+            dict.remove("banana");
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        dict["banana"] += 7;
+        order.clear();
+        dict.forEach([&order](const std::string& key, int) {
+            order.push_back(key);
+        });
+        assert((order == std::vector<std::string>{ "apple", "orange", "banana" }));
+        assert(dict.get("banana") == 7);
+
+        // Рост индекса: ширина ячейки 1 -> 2 -> 4 байта
+        CompactDictionary<int, int> big;
+        assert(big.indexWidth() == 1);
+        const int n = 100000;
+        for (int i = 0; i < n; ++i) {
+            big.put(i, i * 2);
+            if (i == 1000) {
+                assert(big.indexWidth() == 2);
+            }
+        }
+        assert(big.indexWidth() == 4);
+        assert(big.size() == static_cast<size_t>(n));
+        for (int i = 0; i < n; i += 3) {
+            big.remove(i);
+        }
+        for (int i = 0; i < n; ++i) {
+            assert(big.contains(i) == (i % 3 != 0));
+        }
+
+        // Много удалений и вставок: удалённые записи вычищаются, порядок сохраняется
+        CompactDictionary<int, int> churn;
+        for (int round = 0; round < 50; ++round) {
+            for (int i = 0; i < 100; ++i) {
+                churn.put(round * 100 + i, i);
+            }
+            for (int i = 0; i < 100; ++i) {
+                churn.remove(round * 100 + i);
+            }
+        }
+        churn.put(-1, 1);
+        churn.put(-2, 2);
+        assert(churn.size() == 2);
+        assert(churn.sizeInBytes() < 8192);
+        int previous = 0;
+        for (const auto& pair : churn) {
+            assert(pair.first == previous - 1);
+            previous = pair.first;
+        }
+
+        std::cout << "All COMPACT DIC tests passed!" << std::endl;
+    }
+};
@@ -0,0 +1,420 @@
+﻿#pragma once
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+#include "Dictionary.h"
+
+/// <summary>
+/// Ячейка значения ConcurrentDictionary. Для арифметических типов значение атомарное,
+/// чтобы fetch_add по существующему ключу работал под разделяемой блокировкой сегмента.
+/// </summary>
+template <typename Value, bool Arithmetic = std::is_arithmetic<Value>::value>
+struct ConcurrentCell {
+    Value value;
+
+    ConcurrentCell(const Value& initial) : value(initial) {}
+
+    Value load() const {
+        return value;
+    }
+
+    void store(const Value& newValue) {
+        value = newValue;
+    }
+};
+
+template <typename Value>
+struct ConcurrentCell<Value, true> {
+    std::atomic<Value> value;
+
+    ConcurrentCell(const Value& initial) : value(initial) {}
+
+    // Копирование нужно HashTable при вставке пары; выполняется под исключительной блокировкой
+    ConcurrentCell(const ConcurrentCell& other) : value(other.value.load(std::memory_order_relaxed)) {}
+
+    Value load() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    void store(const Value& newValue) {
+        value.store(newValue, std::memory_order_relaxed);
+    }
+
+    /// <summary>
+    /// Атомарно прибавляет delta и возвращает прежнее значение
+    /// (для чисел с плавающей точкой - цикл compare_exchange).
+    /// </summary>
+    Value fetchAdd(const Value& delta) {
+        Value current = value.load(std::memory_order_relaxed);
+        while (!value.compare_exchange_weak(current, static_cast<Value>(current + delta), std::memory_order_relaxed)) {
+        }
+        return current;
+    }
+};
+
+/// <summary>
+/// Потокобезопасный словарь для подсчётов и агрегации из многих потоков.
+/// Ключи распределены по сегментам (по умолчанию 64), у каждого сегмента своя HashTable
+/// пар (ключ, значение) и своя блокировка std::shared_mutex, поэтому потоки с разными ключами
+/// почти не мешают друг другу.
+/// Для арифметических значений fetch_add по существующему ключу берёт только разделяемую
+/// блокировку и делает атомарное сложение: горячие ключи ("the", "and") не выстраивают
+/// потоки в очередь на исключительную блокировку. Ещё меньше общения даёт DeltaBuffer -
+/// локальный для потока буфер приращений, который сбрасывается пачками, по одному захвату
+/// блокировки на сегмент.
+/// </summary>
+/// <typeparam name="Key">Тип ключа</typeparam>
+/// <typeparam name="Value">Тип значения</typeparam>
+template <typename Key, typename Value>
+class ConcurrentDictionary {
+private:
+    using Cell = ConcurrentCell<Value>;
+    using Entry = std::pair<Key, Cell>;
+
+    /// <summary>
+    /// Сегмент словаря, выровненный по кеш-линии, чтобы блокировки соседних сегментов не делили линию.
+    /// </summary>
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        HashTable<Entry> table;
+
+        Shard() : table(entryHash) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards; // Сегменты
+    int shardBits; // log2 количества сегментов
+
+    static size_t entryHash(const Entry& entry) {
+        return fnv1aHash<Key>(entry.first);
+    }
+
+    /// <summary>
+    /// Номер сегмента - старшие биты перемешанного хеша, они не связаны с номером ведра (хеш % ёмкость).
+    /// </summary>
+    size_t shardOf(size_t hash) const {
+        return shardBits == 0 ? 0 : static_cast<size_t>(mix64(hash) >> (64 - shardBits));
+    }
+
+    static Entry* findIn(Shard& shard, size_t hash, const Key& key) {
+        return shard.table.findByHash(hash, [&key](const Entry& entry) {
+            return entry.first == key;
+        });
+    }
+
+    static const Entry* findIn(const Shard& shard, size_t hash, const Key& key) {
+        return shard.table.findByHash(hash, [&key](const Entry& entry) {
+            return entry.first == key;
+        });
+    }
+
+    /// <summary>
+    /// Вставка или объединение под уже взятой исключительной блокировкой сегмента.
+    /// </summary>
+    template <typename MergeFunction>
+    static bool upsertLocked(Shard& shard, size_t hash, const Key& key, const Value& value, MergeFunction& merge) {
+        Entry* existing = findIn(shard, hash, key);
+        if (existing != nullptr) {
+            existing->second.store(merge(existing->second.load(), value));
+            return false;
+        }
+        shard.table.insertByHash(hash, Entry(key, Cell(value)));
+        return true;
+    }
+
+public:
+    /// <summary>
+    /// Конструктор словаря.
+    /// </summary>
+    /// <param name="shardCount">Количество сегментов (округляется вверх до степени двойки).</param>
+    ConcurrentDictionary(size_t shardCount = 64) : shardBits(0) {
+        while ((size_t(1) << shardBits) < shardCount) {
+            shardBits++;
+        }
+        for (size_t i = 0; i < (size_t(1) << shardBits); ++i) {
+            shards.push_back(std::unique_ptr<Shard>(new Shard()));
+        }
+    }
+
+    /// <summary>
+    /// Вставляет (key, init), если ключа нет, иначе заменяет значение на merge(старое, init).
+    /// Выполняется атомарно относительно других операций с этим ключом.
+    /// </summary>
+    /// <param name="key">Ключ.</param>
+    /// <param name="init">Значение для вставки или второй аргумент merge.</param>
+    /// <param name="merge">Функция (const Value&amp; старое, const Value&amp; новое) -> Value.</param>
+    /// <returns>true, если ключ был вставлен.</returns>
+    /// <BigO>Среднее : O(1)</BigO>
+    template <typename MergeFunction>
+    bool upsert(const Key& key, const Value& init, MergeFunction merge) {
+        size_t hash = fnv1aHash<Key>(key);
+        Shard& shard = *shards[shardOf(hash)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return upsertLocked(shard, hash, key, init, merge);
+    }
+
+    /// <summary>
+    /// Атомарно прибавляет delta к значению ключа (отсутствующий ключ считается нулём).
+    /// Для существующего ключа берётся только разделяемая блокировка сегмента.
+    /// </summary>
+    /// <returns>Значение до прибавления.</returns>
+    /// <BigO>Среднее : O(1)</BigO>
+    Value fetch_add(const Key& key, const Value& delta) {
+        static_assert(std::is_arithmetic<Value>::value, "fetch_add requires an arithmetic value type");
+        size_t hash = fnv1aHash<Key>(key);
+        Shard& shard = *shards[shardOf(hash)];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            Entry* existing = findIn(shard, hash, key);
+            if (existing != nullptr) {
+                return existing->second.fetchAdd(delta);
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        Entry* existing = findIn(shard, hash, key); // Ключ мог появиться, пока блокировка была снята
+        if (existing != nullptr) {
+            return existing->second.fetchAdd(delta);
+        }
+        shard.table.insertByHash(hash, Entry(key, Cell(delta)));
+        return Value();
+    }
+
+    /// <summary>
+    /// Получение значения по ключу.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    Value get(const Key& key) const {
+        size_t hash = fnv1aHash<Key>(key);
+        const Shard& shard = *shards[shardOf(hash)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const Entry* existing = findIn(shard, hash, key);
+        if (existing == nullptr) {
+            throw std::runtime_error("Key not found");
+        }
+        return existing->second.load();
+    }
+
+    bool contains(const Key& key) const {
+        size_t hash = fnv1aHash<Key>(key);
+        const Shard& shard = *shards[shardOf(hash)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return findIn(shard, hash, key) != nullptr;
+    }
+
+    /// <summary>
+    /// Удаление ключа.
+    /// </summary>
+    /// <returns>true, если ключ был найден и удалён.</returns>
+    bool remove(const Key& key) {
+        size_t hash = fnv1aHash<Key>(key);
+        Shard& shard = *shards[shardOf(hash)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.table.removeByHash(hash, [&key](const Entry& entry) {
+            return entry.first == key;
+        });
+    }
+
+    /// <summary>
+    /// Количество ключей (сумма по сегментам; при параллельных вставках - моментальный снимок каждого сегмента).
+    /// </summary>
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard->mutex);
+            total += shard->table.size();
+        }
+        return total;
+    }
+
+    /// <summary>
+    /// Обходит все пары (ключ, значение), блокируя сегменты по очереди на чтение.
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const auto& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard->mutex);
+            shard->table.forEachInBuckets(0, shard->table.capacity(), [&visit](const Entry& entry) {
+                visit(entry.first, entry.second.load());
+            });
+        }
+    }
+
+    /// <summary>
+    /// Копирует содержимое в обычный Dictionary (например, для записи отчёта).
+    /// </summary>
+    Dictionary<Key, Value> toDictionary() const {
+        Dictionary<Key, Value> result;
+        forEach([&result](const Key& key, const Value& value) {
+            result.put(key, value);
+        });
+        return result;
+    }
+
+    /// <summary>
+    /// Локальный для потока буфер приращений. Приращения копятся в обычном Dictionary
+    /// и сбрасываются в общий словарь пачкой, когда в буфере накопилось batchSize ключей
+    /// (и в деструкторе). При сбросе пары группируются по сегментам, и каждый сегмент
+    /// блокируется один раз на всю свою часть пачки.
+    /// Сброс выделяет память под новые ключи общего словаря. Деструктор не может бросить исключение,
+    /// поэтому ошибку сброса в нём он подавляет и несброшенные приращения теряются; чтобы узнать
+    /// об ошибке, вызовите flush() явно перед уничтожением буфера.
+    /// </summary>
+    class DeltaBuffer {
+    private:
+        ConcurrentDictionary& target; // Общий словарь
+        Dictionary<Key, Value> deltas; // Накопленные приращения
+        size_t batchSize; // Сколько разных ключей копить до сброса
+
+    public:
+        DeltaBuffer(ConcurrentDictionary& dictionary, size_t batchSize = 4096)
+            : target(dictionary), batchSize(batchSize) {}
+
+        DeltaBuffer(const DeltaBuffer&) = delete;
+        DeltaBuffer& operator=(const DeltaBuffer&) = delete;
+
+        ~DeltaBuffer() {
+            try {
+                flush();
+            }
+            catch (...) {
+                // Приращения, которые не удалось перенести, теряются (см. описание класса)
+            }
+        }
+
+        /// <summary>
+        /// Прибавляет delta к ключу в локальном буфере (без блокировок).
+        /// </summary>
+        void add(const Key& key, const Value& delta) {
+            deltas[key] += delta;
+            if (deltas.size() >= batchSize) {
+                flush();
+            }
+        }
+
+        /// <summary>
+        /// Переносит накопленные приращения в общий словарь.
+        /// Если сброс прервался исключением (например, bad_alloc), в буфере остаются только
+        /// ещё не перенесённые приращения, и повторный flush() не учтёт их дважды.
+        /// </summary>
+        void flush() {
+            if (deltas.size() == 0) {
+                return;
+            }
+
+            std::vector<std::pair<size_t, const std::pair<Key, Value>*>> ordered; // (сегмент, пара)
+            ordered.reserve(deltas.size());
+            for (const auto& pair : deltas) {
+                ordered.emplace_back(target.shardOf(fnv1aHash<Key>(pair.first)), &pair);
+            }
+            std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+
+            auto add = [](const Value& current, const Value& delta) {
+                return static_cast<Value>(current + delta);
+            };
+            size_t applied = 0; // Пары ordered[0..applied) уже перенесены
+            try {
+                while (applied < ordered.size()) {
+                    Shard& shard = *target.shards[ordered[applied].first];
+                    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                    size_t shardIndex = ordered[applied].first;
+                    for (; applied < ordered.size() && ordered[applied].first == shardIndex; ++applied) {
+                        const auto& pair = *ordered[applied].second;
+                        upsertLocked(shard, fnv1aHash<Key>(pair.first), pair.first, pair.second, add);
+                    }
+                }
+            }
+            catch (...) {
+                std::vector<Key> done;
+                done.reserve(applied);
+                for (size_t i = 0; i < applied; ++i) {
+                    done.push_back(ordered[i].second->first);
+                }
+                for (const Key& key : done) {
+                    deltas.remove(key);
+                }
+                throw;
+            }
+            deltas.clear();
+        }
+    };
+
+    /// <summary>
+    /// Функция для тестирования ConcurrentDictionary
+    /// </summary>
+    static void testConcurrentDictionary() {
+        ConcurrentDictionary<std::string, int> counts;
+        assert(counts.size() == 0);
+
+        // upsert с функцией объединения
+        assert(counts.upsert("max", 5, [](int a, int b) { return std::max(a, b); }));
+        assert(!counts.upsert("max", 3, [](int a, int b) { return std::max(a, b); }));
+        assert(!counts.upsert("max", 9, [](int a, int b) { return std::max(a, b); }));
+        assert(counts.get("max") == 9);
+
+        assert(counts.remove("max"));
+        assert(!counts.remove("max"));
+        assert(!counts.contains("max"));
+        try {
+            counts.get("max");
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        // Многопоточный подсчёт: горячие ключи и длинный хвост
+        const int threads = 8;
+        const int perThread = 20000;
+        std::vector<std::string> hot = { "the", "and", "of" };
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&counts, &hot, t]() {
+                ConcurrentDictionary<std::string, int>::DeltaBuffer buffer(counts, 256);
+                for (int i = 0; i < perThread; ++i) {
+                    counts.fetch_add(hot[i % hot.size()], 1);
+                    buffer.add("buffered", 1);
+                    buffer.add("tail" + std::to_string((t * perThread + i) % 1000), 1);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        int hotTotal = counts.get("the") + counts.get("and") + counts.get("of");
+        assert(hotTotal == threads * perThread);
+        assert(counts.get("buffered") == threads * perThread);
+        int tailTotal = 0;
+        counts.forEach([&tailTotal](const std::string& key, int value) {
+            if (key.compare(0, 4, "tail") == 0) {
+                tailTotal += value;
+            }
+        });
+        assert(tailTotal == threads * perThread);
+        assert(counts.size() == 3 + 1 + 1000);
+
+        Dictionary<std::string, int> snapshot = counts.toDictionary();
+        assert(snapshot.size() == counts.size());
+        assert(snapshot.get("buffered") == threads * perThread);
+
+        // Значения с плавающей точкой
+        ConcurrentDictionary<int, double> sums(4);
+        sums.fetch_add(1, 0.5);
+        sums.fetch_add(1, 0.25);
+        assert(sums.get(1) == 0.75);
+
+        std::cout << "All CONCURRENT DIC tests passed!" << std::endl;
+    }
+};
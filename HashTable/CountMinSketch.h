@@ -0,0 +1,448 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+
+/// <summary>
+/// Размеры таблицы скетча (depth строк по width счётчиков) и выбор счётчиков ключа.
+/// Индексы во всех строках получаются из одного 64-битного хеша по схеме Кирша - Митценмахера:
+/// index_i = (h1 + i * h2) mod width, где h1 и h2 - половины хеша (h2 нечётный, width - степень двойки,
+/// поэтому в каждой строке ключ попадает в свой счётчик). Цикл по строкам без ветвлений и
+/// без повторного хеширования ключа компилятор векторизует.
+/// </summary>
+class SketchLayout {
+private:
+    size_t rowWidth; // Счётчиков в строке (степень двойки)
+    size_t rowCount; // Количество строк
+
+public:
+    static constexpr size_t maxDepth = 32; // Знаки CountSketch берутся из битов одного 64-битного слова
+
+    SketchLayout(size_t width, size_t depth) : rowWidth(1), rowCount(depth) {
+        if (width == 0 || width > (size_t(1) << 31)) {
+            throw std::invalid_argument("Sketch width must be in [1, 2^31]");
+        }
+        if (depth == 0 || depth > maxDepth) {
+            throw std::invalid_argument("Sketch depth must be in [1, 32]");
+        }
+        while (rowWidth < width) {
+            rowWidth <<= 1;
+        }
+    }
+
+    /// <summary>
+    /// Заполняет index[0..depth) номерами счётчиков ключа в общем массиве строк.
+    /// </summary>
+    void locate(uint64_t hash, size_t* index) const {
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        uint32_t mask = static_cast<uint32_t>(rowWidth - 1);
+        for (size_t i = 0; i < rowCount; ++i) {
+            index[i] = i * rowWidth + ((h1 + static_cast<uint32_t>(i) * h2) & mask);
+        }
+    }
+
+    size_t width() const {
+        return rowWidth;
+    }
+
+    size_t depth() const {
+        return rowCount;
+    }
+
+    size_t cells() const {
+        return rowWidth * rowCount;
+    }
+
+    bool operator==(const SketchLayout& other) const {
+        return rowWidth == other.rowWidth && rowCount == other.rowCount;
+    }
+};
+
+/// <summary>
+/// Count-Sketch - несмещённая оценка частот: в каждой строке ключ прибавляет свой вес со знаком +-1,
+/// оценка - медиана по строкам (счётчик * знак). Погрешность зависит от второго момента потока,
+/// а не от N, поэтому для редких слов точнее Count-Min, но может быть как больше, так и меньше истины.
+/// Скетч линеен: merge складывает счётчики и даёт ровно скетч объединённого потока,
+/// допускаются отрицательные веса (удаления).
+/// </summary>
+/// <typeparam name="T">Тип элемента</typeparam>
+template <typename T>
+class CountSketch {
+private:
+    SketchLayout layout;
+    std::vector<int64_t> counters; // Строки подряд: depth * width
+
+    // Знак ключа в строке i - бит i второго перемешивания хеша
+    static int64_t sign(uint64_t signs, size_t row) {
+        return ((signs >> row) & 1) ? 1 : -1;
+    }
+
+    /// <summary>
+    /// sum += a * b с проверкой переполнения int64 (проверки делением, без 128-битной арифметики).
+    /// </summary>
+    /// <returns>false, если произведение или сумма не помещаются в int64 (sum не меняется).</returns>
+    static bool multiplyAdd(int64_t a, int64_t b, int64_t& sum) {
+        if (a == 0 || b == 0) {
+            return true;
+        }
+        bool overflow = a > 0
+            ? (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a)
+            : (b > 0 ? a < INT64_MIN / b : b < INT64_MAX / a);
+        if (overflow) {
+            return false;
+        }
+        int64_t product = a * b;
+        if ((product > 0 && sum > INT64_MAX - product) || (product < 0 && sum < INT64_MIN - product)) {
+            return false;
+        }
+        sum += product;
+        return true;
+    }
+
+    static int64_t median(int64_t* values, size_t count) {
+        std::nth_element(values, values + count / 2, values + count);
+        int64_t upper = values[count / 2];
+        if (count % 2 == 1) {
+            return upper;
+        }
+        int64_t lower = *std::max_element(values, values + count / 2);
+        return lower + (upper - lower) / 2;
+    }
+
+public:
+    /// <summary>
+    /// Конструктор скетча заданного размера.
+    /// </summary>
+    /// <param name="width">Счётчиков в строке (округляется вверх до степени двойки).</param>
+    /// <param name="depth">Количество строк (от 1 до 32, лучше нечётное).</param>
+    CountSketch(size_t width, size_t depth) : layout(width, depth), counters(layout.cells(), 0) {}
+
+    /// <summary>
+    /// Учитывает count появлений элемента (отрицательный count - удаление).
+    /// BigO: O(depth)
+    /// </summary>
+    void add(const T& key, int64_t count = 1) {
+        size_t index[SketchLayout::maxDepth];
+        uint64_t hash = keyHash64<T>(key);
+        layout.locate(hash, index);
+        uint64_t signs = mix64(hash ^ 0x9e3779b97f4a7c15ULL);
+        for (size_t i = 0; i < layout.depth(); ++i) {
+            counters[index[i]] += sign(signs, i) * count;
+        }
+    }
+
+    /// <summary>
+    /// Оценка частоты элемента (медиана по строкам).
+    /// BigO: O(depth)
+    /// </summary>
+    int64_t estimate(const T& key) const {
+        size_t index[SketchLayout::maxDepth];
+        int64_t values[SketchLayout::maxDepth] = {};
+        uint64_t hash = keyHash64<T>(key);
+        layout.locate(hash, index);
+        uint64_t signs = mix64(hash ^ 0x9e3779b97f4a7c15ULL);
+        for (size_t i = 0; i < layout.depth(); ++i) {
+            values[i] = sign(signs, i) * counters[index[i]];
+        }
+        return median(values, layout.depth());
+    }
+
+    /// <summary>
+    /// Оценка скалярного произведения векторов частот двух потоков: медиана по строкам
+    /// произведений строк. Произведение скетча на себя оценивает второй момент потока (F2).
+    /// Если произведение строки не помещается в int64, будет сгенерировано исключение overflow_error.
+    /// </summary>
+    int64_t innerProduct(const CountSketch& other) const {
+        if (!(layout == other.layout)) {
+            throw std::invalid_argument("Count sketches have different dimensions");
+        }
+        int64_t rows[SketchLayout::maxDepth] = {};
+        for (size_t i = 0; i < layout.depth(); ++i) {
+            int64_t row = 0;
+            for (size_t j = i * layout.width(); j < (i + 1) * layout.width(); ++j) {
+                if (!multiplyAdd(counters[j], other.counters[j], row)) {
+                    throw std::overflow_error("Count sketch inner product overflows int64");
+                }
+            }
+            rows[i] = row;
+        }
+        return median(rows, layout.depth());
+    }
+
+    /// <summary>
+    /// Добавляет счётчики другого скетча тех же размеров.
+    /// </summary>
+    void merge(const CountSketch& other) {
+        if (!(layout == other.layout)) {
+            throw std::invalid_argument("Count sketches have different dimensions");
+        }
+        for (size_t j = 0; j < counters.size(); ++j) {
+            counters[j] += other.counters[j];
+        }
+    }
+
+    size_t width() const {
+        return layout.width();
+    }
+
+    size_t depth() const {
+        return layout.depth();
+    }
+};
+
+/// <summary>
+/// Count-Min скетч - оценка частот элементов потока за фиксированную память (width * depth счётчиков).
+/// Оценка никогда не меньше истинной частоты и с вероятностью 1 - delta превышает её не больше
+/// чем на epsilon * N (N - суммарный вес потока) при width = e / epsilon, depth = ln(1 / delta).
+/// Консервативное обновление увеличивает только счётчики, меньшие новой оценки, что заметно
+/// уменьшает завышение на скошенных (ципфовых) данных. Скетчи с одинаковыми размерами
+/// объединяются сложением счётчиков (потоки, файлы, шарды).
+/// </summary>
+/// <typeparam name="T">Тип элемента</typeparam>
+template <typename T>
+class CountMinSketch {
+private:
+    SketchLayout layout;
+    std::vector<uint64_t> counters; // Строки подряд: depth * width
+    uint64_t streamLength; // Суммарный вес потока (N)
+    bool conservative; // Консервативное обновление
+
+public:
+    /// <summary>
+    /// Конструктор скетча заданного размера.
+    /// </summary>
+    /// <param name="width">Счётчиков в строке (округляется вверх до степени двойки).</param>
+    /// <param name="depth">Количество строк (от 1 до 32).</param>
+    /// <param name="conservative">Консервативное обновление (точнее, но merge даёт только оценку сверху).</param>
+    CountMinSketch(size_t width, size_t depth, bool conservative = true)
+        : layout(width, depth), counters(layout.cells(), 0), streamLength(0), conservative(conservative) {}
+
+    /// <summary>
+    /// Скетч с погрешностью не больше epsilon * N с вероятностью 1 - delta.
+    /// </summary>
+    static CountMinSketch forError(double epsilon, double delta, bool conservative = true) {
+        if (epsilon <= 0 || epsilon >= 1 || delta <= 0 || delta >= 1) {
+            throw std::invalid_argument("Epsilon and delta must be in (0, 1)");
+        }
+        size_t width = static_cast<size_t>(std::ceil(std::exp(1.0) / epsilon));
+        size_t depth = static_cast<size_t>(std::ceil(std::log(1.0 / delta)));
+        return CountMinSketch(width, std::min(std::max<size_t>(depth, 1), SketchLayout::maxDepth), conservative);
+    }
+
+    /// <summary>
+    /// Учитывает count появлений элемента.
+    /// BigO: O(depth)
+    /// </summary>
+    void add(const T& key, uint64_t count = 1) {
+        size_t index[SketchLayout::maxDepth];
+        layout.locate(keyHash64<T>(key), index);
+        streamLength += count;
+        if (!conservative) {
+            for (size_t i = 0; i < layout.depth(); ++i) {
+                counters[index[i]] += count;
+            }
+            return;
+        }
+        uint64_t target = UINT64_MAX;
+        for (size_t i = 0; i < layout.depth(); ++i) {
+            target = std::min(target, counters[index[i]]);
+        }
+        target += count;
+        for (size_t i = 0; i < layout.depth(); ++i) {
+            counters[index[i]] = std::max(counters[index[i]], target);
+        }
+    }
+
+    /// <summary>
+    /// Оценка частоты элемента (не меньше истинной).
+    /// BigO: O(depth)
+    /// </summary>
+    uint64_t estimate(const T& key) const {
+        size_t index[SketchLayout::maxDepth];
+        layout.locate(keyHash64<T>(key), index);
+        uint64_t result = UINT64_MAX;
+        for (size_t i = 0; i < layout.depth(); ++i) {
+            result = std::min(result, counters[index[i]]);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Оценка скалярного произведения векторов частот двух потоков (размер соединения по ключу):
+    /// минимум по строкам произведений строк. Не меньше истинного значения.
+    /// Строка, произведение которой не помещается в uint64, насыщается до UINT64_MAX -
+    /// оценка остаётся верхней границей.
+    /// </summary>
+    uint64_t innerProduct(const CountMinSketch& other) const {
+        if (!(layout == other.layout)) {
+            throw std::invalid_argument("Count-Min sketches have different dimensions");
+        }
+        uint64_t result = UINT64_MAX;
+        for (size_t i = 0; i < layout.depth(); ++i) {
+            uint64_t row = 0;
+            for (size_t j = i * layout.width(); j < (i + 1) * layout.width(); ++j) {
+                uint64_t a = counters[j];
+                uint64_t b = other.counters[j];
+                if (a != 0 && b > (UINT64_MAX - row) / a) {
+                    row = UINT64_MAX;
+                    break;
+                }
+                row += a * b;
+            }
+            result = std::min(result, row);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Добавляет счётчики другого скетча тех же размеров: результат - скетч объединения потоков.
+    /// </summary>
+    void merge(const CountMinSketch& other) {
+        if (!(layout == other.layout)) {
+            throw std::invalid_argument("Count-Min sketches have different dimensions");
+        }
+        for (size_t j = 0; j < counters.size(); ++j) {
+            counters[j] += other.counters[j];
+        }
+        streamLength += other.streamLength;
+    }
+
+    /// <summary>
+    /// Суммарный вес обработанного потока (N).
+    /// </summary>
+    uint64_t total() const {
+        return streamLength;
+    }
+
+    size_t width() const {
+        return layout.width();
+    }
+
+    size_t depth() const {
+        return layout.depth();
+    }
+
+    /// <summary>
+    /// Функция для тестирования CountMinSketch и CountSketch
+    /// </summary>
+    static void testCountMinSketch() {
+        // Скошенный поток: ключ k встречается примерно в 1 / (k + 1) раз реже
+        const int keys = 5000;
+        std::vector<uint64_t> truth(keys, 0);
+        std::vector<int> stream;
+        uint64_t state = 2024;
+        for (int i = 0; i < 200000; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            double u = static_cast<double>(state >> 11) / 9007199254740992.0;
+            int key = static_cast<int>(std::pow(static_cast<double>(keys), u)) - 1;
+            truth[key]++;
+            stream.push_back(key);
+        }
+
+        CountMinSketch<int> plain(1024, 5, false);
+        CountMinSketch<int> conservative = CountMinSketch<int>::forError(0.003, 0.01);
+        assert(conservative.width() == 1024 && conservative.depth() == 5);
+        CountMinSketch<int> left(1024, 5, false);
+        CountMinSketch<int> right(1024, 5, false);
+        for (size_t i = 0; i < stream.size(); ++i) {
+            plain.add(stream[i]);
+            conservative.add(stream[i]);
+            (i % 2 == 0 ? left : right).add(stream[i]);
+        }
+        assert(plain.total() == stream.size());
+        double bound = std::exp(1.0) / 1024 * stream.size();
+        int withinBound = 0;
+        for (int key = 0; key < keys; ++key) {
+            uint64_t estimate = plain.estimate(key);
+            assert(estimate >= truth[key]);
+            assert(conservative.estimate(key) >= truth[key] && conservative.estimate(key) <= estimate);
+            if (estimate - truth[key] <= bound) {
+                withinBound++;
+            }
+        }
+        assert(withinBound >= keys * 0.99);
+        assert(plain.estimate(0) - truth[0] <= bound); // Частые ключи оцениваются почти точно
+
+        // Объединение половин потока - тот же скетч, что по всему потоку
+        left.merge(right);
+        for (int key = 0; key < keys; ++key) {
+            assert(left.estimate(key) == plain.estimate(key));
+        }
+        assert(left.total() == plain.total());
+
+        // Скалярное произведение: не меньше точного и близко к нему
+        uint64_t exactSelf = 0;
+        for (uint64_t count : truth) {
+            exactSelf += count * count;
+        }
+        uint64_t selfProduct = plain.innerProduct(plain);
+        assert(selfProduct >= exactSelf && selfProduct <= exactSelf + bound * stream.size());
+
+        // Count-Sketch: несмещённые оценки, точное объединение
+        CountSketch<int> sketch(1024, 5);
+        CountSketch<int> even(1024, 5);
+        CountSketch<int> odd(1024, 5);
+        for (size_t i = 0; i < stream.size(); ++i) {
+            sketch.add(stream[i]);
+            (i % 2 == 0 ? even : odd).add(stream[i]);
+        }
+        even.merge(odd);
+        for (int key = 0; key < 100; ++key) {
+            assert(even.estimate(key) == sketch.estimate(key));
+            assert(std::abs(sketch.estimate(key) - static_cast<int64_t>(truth[key])) < static_cast<int64_t>(truth[0] / 10));
+        }
+        double f2 = static_cast<double>(sketch.innerProduct(sketch));
+        assert(std::abs(f2 - exactSelf) < exactSelf * 0.1);
+        sketch.add(0, -static_cast<int64_t>(truth[0])); // Удаление всех появлений ключа 0
+        assert(std::abs(sketch.estimate(0)) < static_cast<int64_t>(truth[0] / 10));
+
+        // Переполнение скалярного произведения: Count-Min насыщается, Count-Sketch сообщает об ошибке
+        CountMinSketch<int> heavy(64, 3);
+        heavy.add(1, uint64_t(1) << 40);
+        assert(heavy.innerProduct(heavy) == UINT64_MAX);
+        CountSketch<int> signedHeavy(64, 3);
+        signedHeavy.add(1, int64_t(1) << 40);
+        try {
+            signedHeavy.innerProduct(signedHeavy);
+            assert(false);
+        }
+        catch (const std::overflow_error&) {
+        }
+        signedHeavy.add(1, -(int64_t(1) << 40) + 3);
+        assert(signedHeavy.innerProduct(signedHeavy) == 9);
+
+        // Строки
+        CountMinSketch<std::string> words(256, 4);
+        words.add("the", 10);
+        words.add("cat");
+        assert(words.estimate("the") == 10 && words.estimate("cat") == 1 && words.estimate("dog") == 0);
+
+        try {
+            CountMinSketch<int> wrong(0, 4);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+        try {
+            plain.merge(CountMinSketch<int>(512, 5));
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+        try {
+            CountSketch<int> tooDeep(64, 33);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+
+        std::cout << "All COUNT-MIN SKETCH tests passed!" << std::endl;
+    }
+};
@@ -0,0 +1,365 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+#include "Set.h"
+
+/// <summary>
+/// Фильтр с кукушкиным хешированием (Cuckoo filter) - вероятностное множество, как фильтр Блума,
+/// но с поддержкой удаления. Хранит 16-битные отпечатки элементов в корзинах по 4 отпечатка.
+/// Каждый элемент может лежать в одной из двух корзин: i1 = hash и i2 = i1 XOR hash(отпечаток),
+/// поэтому вторую корзину можно вычислить по первой и отпечатку, не зная сам элемент.
+/// При переполнении обеих корзин случайный отпечаток "выталкивается" в свою альтернативную корзину.
+/// Доля ложноположительных ответов около 8 / 2^16 = 0.012%, заполнение до 95%.
+/// </summary>
+/// <typeparam name="T">Тип элемента</typeparam>
+template <typename T>
+class CuckooFilter {
+private:
+    static const size_t slotsPerBucket = 4; // Отпечатков в корзине (корзина - 8 байт)
+    static const int maxKicks = 500; // Максимум выталкиваний при вставке
+    static const uint32_t magic = 0x31464B43; // "CKF1" - метка формата сериализации
+    static constexpr size_t readChunkSlots = 1 << 19; // Слотов за одно чтение в deserialize (1 МБ)
+
+    std::vector<uint16_t> slots; // Корзины подряд, 0 - пустой слот
+    size_t mask; // Количество корзин - 1 (степень двойки)
+    size_t _size; // Количество хранимых отпечатков
+    uint64_t randomState; // Состояние генератора для выбора выталкиваемого слота
+    bool hasVictim; // Есть ли отпечаток, не поместившийся после maxKicks выталкиваний
+    size_t victimIndex; // Корзина отпечатка-жертвы
+    uint16_t victimFingerprint; // Отпечаток-жертва
+
+    static uint16_t fingerprintOf(uint64_t hash) {
+        uint16_t fingerprint = static_cast<uint16_t>(hash >> 48);
+        return fingerprint == 0 ? 1 : fingerprint; // 0 зарезервирован под пустой слот
+    }
+
+    size_t alternateIndex(size_t index, uint16_t fingerprint) const {
+        return (index ^ static_cast<size_t>(mix64(fingerprint))) & mask;
+    }
+
+    bool bucketContains(size_t index, uint16_t fingerprint) const {
+        const uint16_t* bucket = &slots[index * slotsPerBucket];
+        bool found = false;
+        for (size_t s = 0; s < slotsPerBucket; ++s) {
+            found |= (bucket[s] == fingerprint);
+        }
+        return found;
+    }
+
+    bool bucketInsert(size_t index, uint16_t fingerprint) {
+        uint16_t* bucket = &slots[index * slotsPerBucket];
+        for (size_t s = 0; s < slotsPerBucket; ++s) {
+            if (bucket[s] == 0) {
+                bucket[s] = fingerprint;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool bucketErase(size_t index, uint16_t fingerprint) {
+        uint16_t* bucket = &slots[index * slotsPerBucket];
+        for (size_t s = 0; s < slotsPerBucket; ++s) {
+            if (bucket[s] == fingerprint) {
+                bucket[s] = 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t nextRandom() {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 7;
+        randomState ^= randomState << 17;
+        return static_cast<size_t>(randomState);
+    }
+
+    /// <summary>
+    /// Вставляет отпечаток, начиная с корзины index (вторая корзина вычисляется по отпечатку).
+    /// </summary>
+    bool insertFingerprint(size_t index, uint16_t fingerprint) {
+        if (hasVictim) {
+            return false; // Фильтр переполнен
+        }
+        size_t other = alternateIndex(index, fingerprint);
+        if (bucketInsert(index, fingerprint) || bucketInsert(other, fingerprint)) {
+            _size++;
+            return true;
+        }
+
+        size_t current = (nextRandom() & 1) ? index : other;
+        for (int kick = 0; kick < maxKicks; ++kick) {
+            uint16_t& slot = slots[current * slotsPerBucket + nextRandom() % slotsPerBucket];
+            std::swap(slot, fingerprint);
+            current = alternateIndex(current, fingerprint);
+            if (bucketInsert(current, fingerprint)) {
+                _size++;
+                return true;
+            }
+        }
+
+        // Отпечаток не поместился: запоминаем его, чтобы не потерять уже вставленный элемент
+        hasVictim = true;
+        victimIndex = current;
+        victimFingerprint = fingerprint;
+        _size++;
+        return true;
+    }
+
+    CuckooFilter() : mask(0), _size(0), randomState(0x2545F4914F6CDD1DULL), hasVictim(false), victimIndex(0), victimFingerprint(0) {}
+
+public:
+    /// <summary>
+    /// Конструктор фильтра под ожидаемое число элементов (корзин - степень двойки, заполнение до 95%).
+    /// </summary>
+    /// <param name="expectedItems">Ожидаемое количество элементов.</param>
+    CuckooFilter(size_t expectedItems) : CuckooFilter() {
+        size_t buckets = 1;
+        while (buckets * slotsPerBucket * 0.95 < expectedItems) {
+            buckets <<= 1;
+        }
+        slots.assign(buckets * slotsPerBucket, 0);
+        mask = buckets - 1;
+    }
+
+    /// <summary>
+    /// Строит фильтр по содержимому множества.
+    /// </summary>
+    CuckooFilter(const Set<T>& set) : CuckooFilter(set.size()) {
+        set.forEach([this](const T& value) {
+            insert(value);
+        });
+    }
+
+    /// <summary>
+    /// Добавляет элемент в фильтр.
+    /// BigO: O(1) амортизированно
+    /// </summary>
+    /// <returns>false, если фильтр переполнен и элемент не добавлен.</returns>
+    bool insert(const T& key) {
+        uint64_t hash = keyHash64<T>(key);
+        return insertFingerprint(static_cast<size_t>(hash) & mask, fingerprintOf(hash));
+    }
+
+    /// <summary>
+    /// Проверяет, может ли элемент быть в фильтре. Просматриваются ровно две корзины.
+    /// </summary>
+    /// <returns>false - элемента точно нет; true - элемент возможно есть.</returns>
+    bool contains(const T& key) const {
+        uint64_t hash = keyHash64<T>(key);
+        uint16_t fingerprint = fingerprintOf(hash);
+        size_t index = static_cast<size_t>(hash) & mask;
+        size_t other = alternateIndex(index, fingerprint);
+        if (hasVictim && victimFingerprint == fingerprint && (victimIndex == index || victimIndex == other)) {
+            return true;
+        }
+        return bucketContains(index, fingerprint) || bucketContains(other, fingerprint);
+    }
+
+    /// <summary>
+    /// Удаляет элемент из фильтра. Удалять можно только ранее вставленные элементы,
+    /// иначе можно стереть отпечаток другого элемента с тем же отпечатком.
+    /// </summary>
+    /// <returns>true, если отпечаток элемента был найден и удалён.</returns>
+    bool remove(const T& key) {
+        uint64_t hash = keyHash64<T>(key);
+        uint16_t fingerprint = fingerprintOf(hash);
+        size_t index = static_cast<size_t>(hash) & mask;
+        size_t other = alternateIndex(index, fingerprint);
+        if (bucketErase(index, fingerprint) || bucketErase(other, fingerprint)) {
+            _size--;
+            if (hasVictim) { // Освободилось место - пробуем вернуть жертву в таблицу
+                hasVictim = false;
+                _size--;
+                insertFingerprint(victimIndex, victimFingerprint);
+            }
+            return true;
+        }
+        if (hasVictim && victimFingerprint == fingerprint && (victimIndex == index || victimIndex == other)) {
+            hasVictim = false;
+            _size--;
+            return true;
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// Добавляет все отпечатки другого фильтра с тем же числом корзин.
+    /// Если фильтр переполнится, будет сгенерировано исключение overflow_error.
+    /// </summary>
+    void merge(const CuckooFilter& other) {
+        if (slots.size() != other.slots.size()) {
+            throw std::invalid_argument("Cuckoo filters have different configuration");
+        }
+        for (size_t i = 0; i < other.slots.size(); ++i) {
+            if (other.slots[i] != 0 && !insertFingerprint(i / slotsPerBucket, other.slots[i])) {
+                throw std::overflow_error("Cuckoo filter is full");
+            }
+        }
+        if (other.hasVictim && !insertFingerprint(other.victimIndex, other.victimFingerprint)) {
+            throw std::overflow_error("Cuckoo filter is full");
+        }
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    /// <summary>
+    /// Доля занятых слотов.
+    /// </summary>
+    double get_loadFactor() const {
+        return static_cast<double>(_size) / slots.size();
+    }
+
+    size_t sizeInBytes() const {
+        return slots.size() * sizeof(uint16_t);
+    }
+
+    /// <summary>
+    /// Записывает фильтр в поток в двоичном виде (порядок байтов платформы).
+    /// Хеш строится на std::hash, поэтому файл читается той же сборкой программы.
+    /// </summary>
+    void serialize(std::ostream& out) const {
+        uint32_t header[2] = { magic, hasVictim ? victimFingerprint : 0u };
+        uint64_t counts[3] = { slots.size() / slotsPerBucket, _size, victimIndex };
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+        out.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(uint16_t)));
+    }
+
+    /// <summary>
+    /// Читает фильтр, записанный serialize.
+    /// Если формат не совпадает, будет сгенерировано исключение runtime_error.
+    /// Слоты читаются порциями по readChunkSlots: повреждённое количество корзин в заголовке
+    /// обрывается на конце потока, а не выделяет память под всё заявленное количество.
+    /// </summary>
+    static CuckooFilter deserialize(std::istream& in) {
+        uint32_t header[2] = { 0, 0 };
+        uint64_t counts[3] = { 0, 0, 0 };
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        in.read(reinterpret_cast<char*>(counts), sizeof(counts));
+        uint64_t buckets = counts[0];
+        if (!in || header[0] != magic || header[1] > UINT16_MAX || buckets == 0 || (buckets & (buckets - 1)) != 0
+            || buckets > SIZE_MAX / (slotsPerBucket * sizeof(uint16_t))
+            || counts[1] > buckets * slotsPerBucket + 1 || counts[2] >= buckets) {
+            throw std::runtime_error("Invalid cuckoo filter data");
+        }
+
+        CuckooFilter filter;
+        filter.mask = static_cast<size_t>(buckets - 1);
+        filter._size = static_cast<size_t>(counts[1]);
+        filter.hasVictim = header[1] != 0;
+        filter.victimFingerprint = static_cast<uint16_t>(header[1]);
+        filter.victimIndex = static_cast<size_t>(counts[2]);
+        size_t slotCount = static_cast<size_t>(buckets * slotsPerBucket);
+        while (filter.slots.size() < slotCount) {
+            size_t begin = filter.slots.size();
+            size_t step = std::min(readChunkSlots, slotCount - begin);
+            filter.slots.resize(begin + step);
+            in.read(reinterpret_cast<char*>(filter.slots.data() + begin), static_cast<std::streamsize>(step * sizeof(uint16_t)));
+            if (!in) {
+                throw std::runtime_error("Invalid cuckoo filter data");
+            }
+        }
+        return filter;
+    }
+
+    /// <summary>
+    /// Функция для тестирования CuckooFilter
+    /// </summary>
+    static void testCuckooFilter() {
+        const int n = 20000;
+        CuckooFilter<int> filter(n);
+        for (int i = 0; i < n; ++i) {
+            assert(filter.insert(i));
+        }
+        assert(filter.size() == static_cast<size_t>(n));
+
+        // Ложноотрицательных ответов нет
+        for (int i = 0; i < n; ++i) {
+            assert(filter.contains(i));
+        }
+
+        // Ложноположительных немного (ожидается около 0.012%)
+        int falsePositives = 0;
+        for (int i = n; i < 3 * n; ++i) {
+            if (filter.contains(i)) {
+                falsePositives++;
+            }
+        }
+        assert(falsePositives < 2 * n / 1000);
+
+        // Удаление
+        for (int i = 0; i < n; i += 2) {
+            assert(filter.remove(i));
+        }
+        assert(filter.size() == static_cast<size_t>(n / 2));
+        for (int i = 1; i < n; i += 2) {
+            assert(filter.contains(i));
+        }
+        int stillPresent = 0;
+        for (int i = 0; i < n; i += 2) {
+            if (filter.contains(i)) {
+                stillPresent++;
+            }
+        }
+        assert(stillPresent < n / 1000);
+
+        // Объединение
+        CuckooFilter<int> other(n);
+        for (int i = 0; i < n; i += 2) {
+            other.insert(i);
+        }
+        filter.merge(other);
+        for (int i = 0; i < n; ++i) {
+            assert(filter.contains(i));
+        }
+
+        // Сериализация
+        std::stringstream buffer;
+        filter.serialize(buffer);
+        CuckooFilter<int> restored = CuckooFilter<int>::deserialize(buffer);
+        assert(restored.size() == filter.size());
+        for (int i = 0; i < 3 * n; ++i) {
+            assert(restored.contains(i) == filter.contains(i));
+        }
+
+        // Повреждённый заголовок: огромное количество корзин без данных
+        {
+            std::stringstream broken;
+            uint32_t header[2] = { magic, 0 };
+            uint64_t counts[3] = { uint64_t(1) << 40, 0, 0 };
+            broken.write(reinterpret_cast<const char*>(header), sizeof(header));
+            broken.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+            broken.write(reinterpret_cast<const char*>(filter.slots.data()), 64);
+            try {
+                CuckooFilter<int>::deserialize(broken);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+        }
+
+        // Построение по множеству строк
+        Set<std::string> words;
+        words.insert("hello");
+        words.insert("world");
+        CuckooFilter<std::string> wordFilter(words);
+        assert(wordFilter.contains("hello") && wordFilter.contains("world"));
+        assert(wordFilter.remove("hello"));
+        assert(!wordFilter.contains("hello"));
+
+        std::cout << "All CUCKOO FILTER tests passed!" << std::endl;
+    }
+};
@@ -1,8 +1,10 @@
-﻿#include <vector>
+﻿#pragma once
+#include <vector>
 #include <list>
 #include <functional>
 #include <stdexcept>
 #include <utility>
+#include <tuple>
 #include "HashTable.h"
 
 /// <summary>
@@ -27,6 +29,25 @@ private:
         return fnv1aHash<Key>(pair.first);
     }
 
+    /// <summary> 
+    /// Поиск пары по ключу: хешируется только ключ, просматривается только его ведро, 
+    /// сравниваются только ключи (значения не участвуют). 
+    /// </summary> 
+    /// <param name="key">Ключ для поиска.</param>
+    /// <returns>Указатель на пару в таблице или nullptr.</returns>
+    /// <BigO>Среднее : O(1)</BigO> 
+    std::pair<Key, Value>* findPair(const Key& key) {
+        return hashTable.findByHash(fnv1aHash<Key>(key), [&key](const std::pair<Key, Value>& pair) {
+            return pair.first == key;
+        });
+    }
+
+    const std::pair<Key, Value>* findPair(const Key& key) const {
+        return hashTable.findByHash(fnv1aHash<Key>(key), [&key](const std::pair<Key, Value>& pair) {
+            return pair.first == key;
+        });
+    }
+
 public:
     /// <summary> 
     /// Конструктор Dictionary. 
@@ -43,19 +64,97 @@ public:
     /// </summary> 
     /// <param name="key">Ключ для вставки или обновления.</param>  
     /// <param name="value">Значение, соответствующее ключу.</param>  
-    /// <BigO>Среднее : O(n)</BigO> 
+    /// <BigO>Среднее : O(1)</BigO> 
     void put(const Key& key, const Value& value) {
-        // Ищем существующий ключ
-        for (auto pair : hashTable) {
-            if (pair.first == key) {
-                hashTable.remove(pair);
-                hashTable.insert(std::make_pair(key, value));
-                // Обновляем значение
-                return;
-            }
+        insert_or_assign(key, value);
+    }
+
+    /// <summary> 
+    /// Вставляет пару (key, Value(args...)), только если ключа ещё нет.  
+    /// Значение создаётся только при вставке; хеш ключа вычисляется один раз.
+    /// </summary> 
+    /// <param name="key">Ключ.</param>  
+    /// <param name="args">Аргументы конструктора значения.</param>  
+    /// <returns>Пара (указатель на значение в словаре, true если пара была вставлена).</returns>  
+    /// <BigO>Среднее : O(1)</BigO> 
+    template <typename... Args>
+    std::pair<Value*, bool> try_emplace(const Key& key, Args&&... args) {
+        size_t hash = fnv1aHash<Key>(key);
+        std::pair<Key, Value>* existing = hashTable.findByHash(hash, [&key](const std::pair<Key, Value>& pair) {
+            return pair.first == key;
+        });
+        if (existing != nullptr) {
+            return std::make_pair(&existing->second, false);
+        }
+        std::pair<Key, Value>* inserted = hashTable.insertByHash(hash,
+            std::pair<Key, Value>(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...)));
+        return std::make_pair(&inserted->second, true);
+    }
+
+    /// <summary> 
+    /// Вставляет пару или присваивает новое значение существующему ключу (на месте).  
+    /// </summary> 
+    /// <param name="key">Ключ.</param>  
+    /// <param name="value">Новое значение.</param>  
+    /// <returns>Пара (указатель на значение в словаре, true если пара была вставлена).</returns>  
+    /// <BigO>Среднее : O(1)</BigO> 
+    template <typename M>
+    std::pair<Value*, bool> insert_or_assign(const Key& key, M&& value) {
+        size_t hash = fnv1aHash<Key>(key);
+        std::pair<Key, Value>* existing = hashTable.findByHash(hash, [&key](const std::pair<Key, Value>& pair) {
+            return pair.first == key;
+        });
+        if (existing != nullptr) {
+            existing->second = std::forward<M>(value);
+            return std::make_pair(&existing->second, false);
+        }
+        std::pair<Key, Value>* inserted = hashTable.insertByHash(hash, std::pair<Key, Value>(key, std::forward<M>(value)));
+        return std::make_pair(&inserted->second, true);
+    }
+
+    /// <summary> 
+    /// Доступ к значению по ключу; если ключа нет, вставляется значение по умолчанию.  
+    /// Удобно для счётчиков: dict[word]++ - один поиск и изменение на месте.
+    /// </summary> 
+    /// <param name="key">Ключ.</param>  
+    /// <returns>Ссылка на значение в словаре.</returns>  
+    /// <BigO>Среднее : O(1)</BigO> 
+    Value& operator[](const Key& key) {
+        return *try_emplace(key).first;
+    }
+
+    /// <summary> 
+    /// Поиск значения по ключу без копирования.  
+    /// </summary> 
+    /// <param name="key">Ключ.</param>  
+    /// <returns>Указатель на значение в словаре или nullptr, если ключа нет.
+    /// Указатель действителен до удаления ключа.</returns>  
+    /// <BigO>Среднее : O(1)</BigO> 
+    Value* find(const Key& key) {
+        std::pair<Key, Value>* existing = findPair(key);
+        return existing == nullptr ? nullptr : &existing->second;
+    }
+
+    const Value* find(const Key& key) const {
+        const std::pair<Key, Value>* existing = findPair(key);
+        return existing == nullptr ? nullptr : &existing->second;
+    }
+
+    /// <summary> 
+    /// Изменяет значение по ключу на месте: вызывает fn(value) для хранимого значения.  
+    /// </summary> 
+    /// <param name="key">Ключ.</param>  
+    /// <param name="fn">Функция, принимающая Value&amp;.</param>  
+    /// <returns>true, если ключ найден и значение изменено.</returns>  
+    /// <BigO>Среднее : O(1)</BigO> 
+    template <typename Function>
+    bool update(const Key& key, Function fn) {
+        Value* value = find(key);
+        if (value == nullptr) {
+            return false;
         }
-        // Если ключ не найден, вставляем новую пару
-        hashTable.insert(std::make_pair(key, value));
+        fn(*value);
+        return true;
     }
 
     /// <summary> 
@@ -63,29 +162,37 @@ public:
     /// </summary>  
     /// <param name="key">Ключ для поиска значения.</param>  
     /// <returns>Значение, соответствующее ключу.</returns>  
-    /// <BigO>Среднее : O(n)</BigO> 
-    Value get(const Key& key) {
-        for (const auto& pair : hashTable) {
-            if (pair.first == key) {
-                return pair.second;
-            }
+    /// <BigO>Среднее : O(1)</BigO> 
+    Value get(const Key& key) const {
+        const std::pair<Key, Value>* existing = findPair(key);
+        if (existing == nullptr) {
+            throw std::runtime_error("Key not found");
         }
-        throw std::runtime_error("Key not found");
+        return existing->second;
+    }
+
+    /// <summary> 
+    /// Проверка наличия ключа в словаре.  
+    /// </summary>  
+    /// <param name="key">Ключ для поиска.</param>  
+    /// <returns>true, если ключ есть в словаре.</returns>  
+    /// <BigO>Среднее : O(1)</BigO> 
+    bool contains(const Key& key) const {
+        return findPair(key) != nullptr;
     }
 
     /// <summary> 
     /// Удаление пары (ключ, значение) по ключу.  
     /// </summary>  
     /// <param name="key">Ключ для удаления.</param>  
-    /// <BigO>Среднее : O(n)</BigO>
+    /// <BigO>Среднее : O(1)</BigO>
     void remove(const Key& key) {
-        for (const auto& pair : hashTable) {
-            if (pair.first == key) {
-                hashTable.remove(pair);
-                return;
-            }
+        bool removed = hashTable.removeByHash(fnv1aHash<Key>(key), [&key](const std::pair<Key, Value>& pair) {
+            return pair.first == key;
+        });
+        if (!removed) {
+            throw std::runtime_error("Key not found");
         }
-        throw std::runtime_error("Key not found");
     }
 
     /// <summary> 
@@ -104,6 +211,16 @@ public:
         hashTable.clear();
     }
 
+    /// <summary>
+    /// Обходит все пары (ключ, значение) без копирования, в том же порядке, что и итератор.
+    /// В отличие от итератора, доступен и для константного словаря.
+    /// </summary>
+    /// <param name="visit">Функция, вызываемая для каждой пары (const std::pair&lt;Key, Value&gt;&amp;).</param>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        hashTable.forEachInBuckets(0, hashTable.capacity(), visit);
+    }
+
     // Итератор для Dictionary
     class Iterator {
     private:
@@ -117,8 +234,8 @@ public:
             : current(start), end(end) {}
 
         // Оператор разыменования
-        std::pair<Key, Value> operator*() {
-            return *current; // Возвращает текущую пару
+        const std::pair<Key, Value>& operator*() const {
+            return *current; // Возвращает текущую пару без копирования
         }
 
         // Оператор инкремента
@@ -218,6 +335,69 @@ public:
             std::cout << element.first << ": " << element.second << std::endl;
         }
 
+        // Тест 5: Большой словарь - поиск, обновление и удаление по ключу
+        Dictionary<int, int> bigDict;
+        for (int i = 0; i < 20000; ++i) {
+            bigDict.put(i, i * 2);
+        }
+        assert(bigDict.size() == 20000);
+        for (int i = 0; i < 20000; ++i) {
+            assert(bigDict.get(i) == i * 2);
+        }
+        for (int i = 0; i < 20000; i += 2) {
+            bigDict.put(i, -i); // Обновление не меняет размер
+        }
+        assert(bigDict.size() == 20000);
+        assert(bigDict.get(10) == -10 && bigDict.get(11) == 22);
+        for (int i = 0; i < 10000; ++i) {
+            bigDict.remove(i);
+        }
+        assert(bigDict.size() == 10000);
+        assert(!bigDict.contains(0) && bigDict.contains(10000));
+
+        size_t iterated = 0;
+        for (const auto& pair : bigDict) {
+            assert(pair.first >= 10000);
+            iterated++;
+        }
+        assert(iterated == bigDict.size()); // Итератор обходит все ведра, включая последнее
+
+        // Тест 6: Изменение значений на месте
+        Dictionary<std::string, int> counters;
+        counters["the"]++;
+        counters["the"]++;
+        counters["and"] += 5;
+        assert(counters.get("the") == 2 && counters.get("and") == 5);
+        assert(counters.size() == 2);
+
+        auto emplaced = counters.try_emplace("the", 100);
+        assert(!emplaced.second && *emplaced.first == 2); // Существующее значение не меняется
+        emplaced = counters.try_emplace("of", 7);
+        assert(emplaced.second && *emplaced.first == 7);
+
+        auto assigned = counters.insert_or_assign("of", 8);
+        assert(!assigned.second && counters.get("of") == 8);
+        assigned = counters.insert_or_assign("a", 1);
+        assert(assigned.second && counters.get("a") == 1);
+
+        int* found = counters.find("and");
+        assert(found != nullptr && *found == 5);
+        *found = 6;
+        assert(counters.get("and") == 6);
+        assert(counters.find("missing") == nullptr);
+
+        assert(counters.update("a", [](int& value) { value *= 10; }));
+        assert(counters.get("a") == 10);
+        assert(!counters.update("missing", [](int& value) { value = 0; }));
+
+        // Указатель на значение переживает рост таблицы
+        int* stable = &counters["stable"];
+        for (int i = 0; i < 1000; ++i) {
+            counters[std::to_string(i)] = i;
+        }
+        *stable = 42;
+        assert(counters.get("stable") == 42);
+
         // Общий тест завершен
         std::cout << "All DIC tests passed successfully!" << std::endl;
     }
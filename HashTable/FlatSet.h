@@ -0,0 +1,329 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <cassert>
+#include <iostream>
+#include <string>
+
+/// <summary>
+/// Множество на основе отсортированного непрерывного std::vector, с тем же интерфейсом, что и Set.
+/// Подходит для множеств, которые строятся один раз и потом часто проверяются:
+/// нет узлов и указателей, элементы лежат подряд и обходятся по возрастанию.
+/// Поиск - бинарный без ветвлений (сравнение превращается в условную пересылку),
+/// а для больших множеств - по копии в порядке Эйтцингера (дерево в массиве, как у кучи),
+/// где первые уровни поиска всегда попадают в одни и те же кеш-линии.
+/// Порядок Эйтцингера строится при массовой вставке (insertRange, конструктор из диапазона)
+/// и сбрасывается одиночными insert/remove до следующей массовой вставки или rebuildIndex().
+/// </summary>
+/// <BigO>
+/// contains - O(log n). insert/remove - O(n) (сдвиг массива). insertRange - O((n + m) log m).
+/// </BigO>
+/// <typeparam name="Value">Тип элемента, должен поддерживать operator&lt;</typeparam>
+template <typename Value>
+class FlatSet {
+private:
+    std::vector<Value> data; // Отсортированные уникальные элементы
+    std::vector<Value> eytzinger; // Те же элементы в порядке Эйтцингера, индексы с 1 (eytzinger[0] не используется)
+    bool eytzingerValid = false; // Соответствует ли eytzinger текущему data
+
+    // Начиная с этого размера contains использует порядок Эйтцингера
+    static const size_t eytzingerThreshold = 1024;
+
+    /// <summary>
+    /// Рекурсивно раскладывает отсортированные элементы по узлам неявного дерева (обход in-order).
+    /// </summary>
+    size_t fillEytzinger(size_t index, size_t k) {
+        if (k < eytzinger.size()) {
+            index = fillEytzinger(index, 2 * k);
+            eytzinger[k] = data[index++];
+            index = fillEytzinger(index, 2 * k + 1);
+        }
+        return index;
+    }
+
+    /// <summary>
+    /// Бинарный поиск без ветвлений: на каждом шаге база сдвигается на половину
+    /// или остаётся на месте, в зависимости от одного сравнения.
+    /// </summary>
+    bool branchlessContains(const Value& value) const {
+        size_t n = data.size();
+        if (n == 0) {
+            return false;
+        }
+        const Value* base = data.data();
+        while (n > 1) {
+            size_t half = n / 2;
+            base = (base[half] < value) ? base + half : base;
+            n -= half;
+        }
+        base += (*base < value);
+        return base != data.data() + data.size() && !(value < *base);
+    }
+
+    /// <summary>
+    /// Поиск по порядку Эйтцингера: спуск k = 2k или 2k + 1, затем откат
+    /// к последнему узлу, где свернули влево, - это нижняя граница значения.
+    /// </summary>
+    bool eytzingerContains(const Value& value) const {
+        size_t n = eytzinger.size();
+        size_t k = 1;
+        while (k < n) {
+            k = 2 * k + (eytzinger[k] < value);
+        }
+        while (k & 1) { // Снимаем правые повороты
+            k >>= 1;
+        }
+        k >>= 1;
+        return k != 0 && !(value < eytzinger[k]);
+    }
+
+public:
+    FlatSet() {}
+
+    /// <summary>
+    /// Массовое построение из диапазона: один sort + unique вместо поэлементных вставок.
+    /// </summary>
+    template <typename InputIt>
+    FlatSet(InputIt first, InputIt last) {
+        insertRange(first, last);
+    }
+
+    // Итератор - итератор отсортированного массива, обход по возрастанию
+    using Iterator = typename std::vector<Value>::const_iterator;
+
+    /// <summary>
+    /// Вставка элемента в множество с сохранением порядка.
+    /// Если элемент уже существует, повторная вставка не происходит.
+    /// </summary>
+    /// <returns>Пара (итератор на элемент, true если элемент был вставлен) - как у Set::insert.
+    /// Итератор действителен до следующего изменения множества.</returns>
+    std::pair<Iterator, bool> insert(const Value& value) {
+        auto it = std::lower_bound(data.begin(), data.end(), value);
+        if (it != data.end() && !(value < *it)) {
+            return std::make_pair(Iterator(it), false);
+        }
+        it = data.insert(it, value);
+        eytzingerValid = false;
+        return std::make_pair(Iterator(it), true);
+    }
+
+    /// <summary>
+    /// Массовая вставка: новые элементы дописываются в конец, сортируются,
+    /// сливаются с уже имеющимися и очищаются от повторов. Затем перестраивается порядок Эйтцингера.
+    /// </summary>
+    template <typename InputIt>
+    void insertRange(InputIt first, InputIt last) {
+        size_t oldSize = data.size();
+        data.insert(data.end(), first, last);
+        std::sort(data.begin() + oldSize, data.end());
+        std::inplace_merge(data.begin(), data.begin() + oldSize, data.end());
+        data.erase(std::unique(data.begin(), data.end(), [](const Value& a, const Value& b) {
+            return !(a < b) && !(b < a);
+        }), data.end());
+        rebuildIndex();
+    }
+
+    /// <summary>
+    /// Перестраивает копию в порядке Эйтцингера (для множеств от eytzingerThreshold элементов).
+    /// </summary>
+    void rebuildIndex() {
+        eytzinger.clear();
+        if (data.size() >= eytzingerThreshold) {
+            eytzinger.resize(data.size() + 1);
+            fillEytzinger(0, 1);
+            eytzingerValid = true;
+        }
+        else {
+            eytzinger.shrink_to_fit();
+            eytzingerValid = false;
+        }
+    }
+
+    /// <summary>
+    /// Проверка на наличие элемента в множестве.
+    /// </summary>
+    bool contains(const Value& value) const {
+        if (eytzingerValid) {
+            return eytzingerContains(value);
+        }
+        return branchlessContains(value);
+    }
+
+    /// <summary>
+    /// Удаление элемента из множества.
+    /// Если элемент не найден, будет сгенерировано исключение runtime_error (как в Set).
+    /// </summary>
+    void remove(const Value& value) {
+        auto it = std::lower_bound(data.begin(), data.end(), value);
+        if (it == data.end() || value < *it) {
+            throw std::runtime_error("Key not found");
+        }
+        data.erase(it);
+        eytzingerValid = false;
+    }
+
+    void clear() {
+        data.clear();
+        eytzinger.clear();
+        eytzingerValid = false;
+    }
+
+    size_t size() const {
+        return data.size();
+    }
+
+    void reserve(size_t n) {
+        data.reserve(n);
+    }
+
+    /// <summary>
+    /// Обходит элементы по возрастанию.
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const auto& value : data) {
+            visit(value);
+        }
+    }
+
+    /// <summary>
+    /// Операции над множествами - линейные слияния отсортированных массивов.
+    /// </summary>
+    FlatSet operator|(const FlatSet& other) const {
+        FlatSet result;
+        result.data.reserve(data.size() + other.data.size());
+        std::set_union(data.begin(), data.end(), other.data.begin(), other.data.end(), std::back_inserter(result.data));
+        result.rebuildIndex();
+        return result;
+    }
+
+    FlatSet operator&(const FlatSet& other) const {
+        FlatSet result;
+        result.data.reserve(std::min(data.size(), other.data.size()));
+        std::set_intersection(data.begin(), data.end(), other.data.begin(), other.data.end(), std::back_inserter(result.data));
+        result.rebuildIndex();
+        return result;
+    }
+
+    FlatSet operator-(const FlatSet& other) const {
+        FlatSet result;
+        result.data.reserve(data.size());
+        std::set_difference(data.begin(), data.end(), other.data.begin(), other.data.end(), std::back_inserter(result.data));
+        result.rebuildIndex();
+        return result;
+    }
+
+    FlatSet operator^(const FlatSet& other) const {
+        FlatSet result;
+        result.data.reserve(data.size() + other.data.size());
+        std::set_symmetric_difference(data.begin(), data.end(), other.data.begin(), other.data.end(), std::back_inserter(result.data));
+        result.rebuildIndex();
+        return result;
+    }
+
+    bool isSubsetOf(const FlatSet& other) const {
+        return size() <= other.size() && std::includes(other.data.begin(), other.data.end(), data.begin(), data.end());
+    }
+
+    bool isDisjoint(const FlatSet& other) const {
+        auto a = data.begin();
+        auto b = other.data.begin();
+        while (a != data.end() && b != other.data.end()) {
+            if (*a < *b) {
+                ++a;
+            }
+            else if (*b < *a) {
+                ++b;
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Iterator begin() const {
+        return data.begin();
+    }
+
+    Iterator end() const {
+        return data.end();
+    }
+
+    /// <summary>
+    /// Функция для тестирования класса FlatSet
+    /// </summary>
+    static void testFlatSet() {
+        FlatSet<int> intSet;
+        assert(intSet.size() == 0);
+        assert(!intSet.contains(1));
+
+        assert(intSet.insert(3).second);
+        assert(intSet.insert(1).second);
+        auto inserted = intSet.insert(2);
+        assert(inserted.second && *inserted.first == 2);
+        auto duplicate = intSet.insert(2); // Дубликат
+        assert(!duplicate.second && *duplicate.first == 2);
+        assert(intSet.size() == 3);
+        assert(intSet.contains(1) && intSet.contains(2) && intSet.contains(3));
+        assert(!intSet.contains(0) && !intSet.contains(4));
+
+        std::vector<int> walked(intSet.begin(), intSet.end());
+        assert((walked == std::vector<int>{ 1, 2, 3 })); // Обход по возрастанию
+
+        intSet.remove(2);
+        assert(!intSet.contains(2) && intSet.size() == 2);
+        try {
+            intSet.remove(2);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        // Массовая вставка с повторами, переход к порядку Эйтцингера
+        std::vector<int> input;
+        for (int i = 5000; i > 0; --i) {
+            input.push_back(i * 2);
+            input.push_back(i * 2);
+        }
+        FlatSet<int> evens(input.begin(), input.end());
+        assert(evens.size() == 5000);
+        for (int i = 0; i <= 10002; ++i) {
+            assert(evens.contains(i) == (i % 2 == 0 && i >= 2 && i <= 10000));
+        }
+        evens.insert(7); // Сбрасывает порядок Эйтцингера, поиск продолжает работать
+        assert(evens.contains(7) && evens.contains(10000) && !evens.contains(9));
+        evens.rebuildIndex();
+        assert(evens.contains(7) && !evens.contains(9));
+
+        // Дозаливка в непустое множество
+        std::vector<int> more = { 1, 3, 7, 10001 };
+        evens.insertRange(more.begin(), more.end());
+        assert(evens.size() == 5004); // 7 уже был в множестве
+        assert(evens.contains(1) && evens.contains(10001));
+
+        // Операции над множествами
+        std::vector<int> left = { 1, 2, 3, 4, 5 };
+        std::vector<int> right = { 4, 5, 6 };
+        FlatSet<int> a(left.begin(), left.end());
+        FlatSet<int> b(right.begin(), right.end());
+        assert((a | b).size() == 6);
+        assert((a & b).size() == 2);
+        assert((a - b).size() == 3);
+        assert((a ^ b).size() == 4);
+        assert((a & b).isSubsetOf(a) && !a.isSubsetOf(b));
+        assert((a - b).isDisjoint(b) && !a.isDisjoint(b));
+
+        // Строки
+        FlatSet<std::string> words;
+        words.insert("banana");
+        words.insert("apple");
+        assert(words.contains("apple") && !words.contains("grape"));
+        assert(*words.begin() == "apple");
+
+        std::cout << "All FLAT SET tests passed!" << std::endl;
+    }
+};
@@ -1,30 +1,56 @@
 ﻿#include <iostream>
 #include <unordered_map>
+#include <unordered_set>
 #include <cctype> // Для std::tolower
 #include <utility> // Для std::pair
 #include <fstream> // Для работы с файлами
-#include <codecvt>
 #include <locale>
 #include <algorithm>
 #include <string>
 #include <sstream>
+#include <string_view>
+#include <cwctype>
+#include <thread>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <climits>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 #include "Dictionary.h"
+#include "MappedFile.h"
+#include "StringPool.h"
+#include "Utf8Tokenizer.h"
+#include "SpaceSaving.h"
+#include "CountMinSketch.h"
 
 using namespace std;
 
 // Функция для создания SVG файла из полученного закона Ципфа, показывает только 150 рангов
-void createSvg(const std::vector<std::pair<std::wstring, int>>& frequencies, const std::string& title) {
+// (файл - path, по умолчанию title + ".svg")
+void createSvg(const std::vector<std::pair<std::wstring, int>>& frequencies, const std::string& title, const std::string& path = "") {
     const int width = 800;
     const int height = 600;
     const int margin = 50;
-    int stopIt = 150;
     int whiii = 0;
+    if (frequencies.empty()) {
+        return;
+    }
+    // Короткий текст (например, из stdin) может дать меньше 150 рангов
+    int stopIt = static_cast<int>(std::min<size_t>(150, frequencies.size() - 1));
 
     // Определение максимальной частоты для нормализации 
     int maxFrequency = frequencies.front().second;
 
-    std::ofstream svgFile(title + ".svg");
+    std::ofstream svgFile(path.empty() ? title + ".svg" : path);
     svgFile << "<svg width=\"" << width << "\" height=\"" << height << "\" xmlns=\"http://www.w3.org/2000/svg\">\n";
     svgFile << "<text x=\"" << width / 2 << "\" y=\"20\" text-anchor=\"middle\" font-size=\"16\">" << title << "</text>\n";
 
@@ -52,24 +78,24 @@ void createSvg(const std::vector<std::pair<std::wstring, int>>& frequencies, con
 // std::wstring — это класс, представляющий строку символов типа wchar_t. 
 // Он используется для хранения текстовых данных, которые могут содержать символы, выходящие за 
 // пределы стандартного ASCII (например, кириллица, иероглифы и т. д.). 
+// (decodeUtf8 вместо std::wstring_convert: <codecvt> устарел в C++17, а MSVC с /sdl считает это ошибкой)
 std::wstring utf8ToWstring(const std::string& str) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter; // Создание конвертера
-    return converter.from_bytes(str); // Преобразование строки
+    return decodeUtf8(str); // Преобразование строки
 }
 
 // Функция для чтения текста из файла и возврата его в виде wstring
 std::wstring readTextFromFile(const std::string& filename) {
-    // std::wifstream — это класс для чтения из файлов, содержащих широкие символы. Он позволяет открывать файлы и
-    // считывать из них данные, используя операции ввода, аналогичные тем, что используются с обычными потоками.
-    std::wifstream file(filename); // Открытие файла для чтения в формате wide string
-    file.imbue(std::locale(file.getloc(), new std::codecvt_utf8<wchar_t>)); // Установка локали для поддержки UTF-8
-    std::wstringstream buffer; // Создание буфера для чтения содержимого файла
+    // Файл читается как байты UTF-8 и декодируется decodeUtf8 (без устаревшего codecvt_utf8)
+    std::ifstream file(filename, std::ios::binary); // Открытие файла для чтения байтов
+    std::stringstream buffer; // Создание буфера для чтения содержимого файла
     buffer << file.rdbuf(); // Чтение содержимого файла в буфер
-    return buffer.str(); // Возврат прочитанного текста
+    return decodeUtf8(buffer.str()); // Возврат прочитанного текста
 }
 
 // Функция для записи частот слов в файл
-void writeFrequenciesToFile(const std::vector<std::pair<std::wstring, int>>& frequencies, const std::string& filename) {
+// (errors - погрешности приближённого подсчёта по рангам: истинная частота не меньше частоты минус погрешность)
+void writeFrequenciesToFile(const std::vector<std::pair<std::wstring, int>>& frequencies, const std::string& filename,
+    const std::vector<uint64_t>* errors = nullptr) {
     //std::wofstream — это класс для записи в файлы, содержащие широкие символы. 
     // Он позволяет открывать файлы и записывать в них данные, используя операции вывода.
     std::wofstream outputFile(filename); // Открытие файла для записи в формате wide string
@@ -79,15 +105,97 @@ void writeFrequenciesToFile(const std::vector<std::pair<std::wstring, int>>& fre
     }
 
     // Записываем заголовок в файл  
-    outputFile << L"Слово;Частота;Ранг" << std::endl;
+    outputFile << (errors != nullptr ? L"Слово;Частота;Погрешность;Ранг" : L"Слово;Частота;Ранг") << std::endl;
 
     int rank = 1; // Инициализация ранга с единицы
     for (const auto& pair : frequencies) { // Перебор всех пар (слово, частота)
-        outputFile << pair.first << L";" << pair.second << L";" << rank << std::endl; // Запись слова, частоты и ранга в файл
+        outputFile << pair.first << L";" << pair.second << L";"; // Запись слова и частоты
+        if (errors != nullptr) {
+            outputFile << (*errors)[rank - 1] << L";"; // Запись погрешности
+        }
+        outputFile << rank << std::endl; // Запись ранга
         rank++; // Увеличение ранга для следующего слова
     }
 }
 
+// Порядок рангов: по убыванию частоты, слова с равной частотой - по алфавиту
+// (чтобы результат не зависел от порядка хеш-таблицы и от числа потоков)
+bool frequencyOrder(const std::pair<std::wstring, int>& a, const std::pair<std::wstring, int>& b) {
+    return a.second > b.second || (a.second == b.second && a.first < b.first);
+}
+
+// Сортировка подсчётом по частоте за O(n + maxCount): слова раскладываются по корзинам частот 
+// (от большей к меньшей), затем слова внутри корзины сортируются по алфавиту - тот же порядок, что frequencyOrder. 
+// Частоты ципфовы: корзин мало, а в больших корзинах (1, 2, ...) сравниваются только слова. 
+// Если максимальная частота намного больше числа слов, корзины дороже сортировки - используется std::sort.
+void rankByCount(std::vector<std::pair<std::wstring, int>>& frequencies) {
+    int maxCount = 0;
+    int minCount = 0;
+    for (const auto& pair : frequencies) {
+        maxCount = std::max(maxCount, pair.second);
+        minCount = std::min(minCount, pair.second);
+    }
+    if (minCount < 0 || static_cast<size_t>(maxCount) > 4 * frequencies.size() + 1024) {
+        std::sort(frequencies.begin(), frequencies.end(), frequencyOrder);
+        return;
+    }
+
+    // Начало каждой корзины (корзина b - частота maxCount - b)
+    std::vector<size_t> bucketStart(static_cast<size_t>(maxCount) + 2, 0);
+    for (const auto& pair : frequencies) {
+        bucketStart[maxCount - pair.second + 1]++;
+    }
+    for (size_t b = 1; b < bucketStart.size(); ++b) {
+        bucketStart[b] += bucketStart[b - 1];
+    }
+    std::vector<std::pair<std::wstring, int>> ranked(frequencies.size());
+    for (auto& pair : frequencies) {
+        ranked[bucketStart[maxCount - pair.second]++] = std::move(pair);
+    }
+
+    // Слова с равной частотой - по алфавиту
+    for (size_t begin = 0, end; begin < ranked.size(); begin = end) {
+        end = begin + 1;
+        while (end < ranked.size() && ranked[end].second == ranked[begin].second) {
+            end++;
+        }
+        if (end - begin > 1) {
+            std::sort(ranked.begin() + begin, ranked.begin() + end,
+                [](const std::pair<std::wstring, int>& a, const std::pair<std::wstring, int>& b) {
+                    return a.first < b.first;
+                });
+        }
+    }
+    frequencies.swap(ranked);
+}
+
+// Упорядочивает частоты по рангам (rankByCount). Если top > 0, оставляет только top первых рангов: 
+// nth_element отбирает их за O(n), затем сортируются только они - O(n + top log top) вместо O(n log n)
+void keepTopFrequencies(std::vector<std::pair<std::wstring, int>>& frequencies, size_t top) {
+    if (top > 0 && top < frequencies.size()) {
+        std::nth_element(frequencies.begin(), frequencies.begin() + top, frequencies.end(), frequencyOrder);
+        frequencies.erase(frequencies.begin() + top, frequencies.end());
+        std::sort(frequencies.begin(), frequencies.end(), frequencyOrder);
+        return;
+    }
+    rankByCount(frequencies);
+}
+
+// Переносит подсчитанные частоты в вектор и сортирует в порядке рангов (top > 0 - только top первых рангов)
+std::vector<std::pair<std::wstring, int>> rankFrequencies(const std::unordered_map<std::wstring, int>& wordCount, size_t top = 0) {
+    // Вектор для хранения пар слово-частота
+    std::vector<std::pair<std::wstring, int>> frequencies;
+    frequencies.reserve(wordCount.size());
+    for (const auto& pair : wordCount) {
+        frequencies.emplace_back(pair.first, pair.second);
+    }
+
+    // Сортируем вектор по частоте
+    keepTopFrequencies(frequencies, top);
+
+    return frequencies; // Возвращаем отсортированный вектор
+}
+
 /// <summary> 
 /// Закон Ципфа — это эмпирическое правило, согласно которому частота слов в текстах обратно пропорциональна их рангу. 
 /// Другими словами, слово, занимающее первое место по частоте, будет встречаться в n раз чаще, чем слово,  
@@ -96,8 +204,9 @@ void writeFrequenciesToFile(const std::vector<std::pair<std::wstring, int>>& fre
 /// - В худшем случае, когда все слова уникальны(m = n), сложность составит O(n log n). 
 /// </summary> 
 /// <param name="text">Текст, что нужно обработать</param> 
+/// <param name="top">Сколько первых рангов вернуть (0 - все слова)</param> 
 /// <returns>vector<pair<string, int>> - отсортированный по убыванию массив из пар (слово, частота)</returns> 
-std::vector<std::pair<std::wstring, int>> zipfsLaw(const std::wstring& text) {
+std::vector<std::pair<std::wstring, int>> zipfsLaw(const std::wstring& text, size_t top = 0) {
     std::unordered_map<std::wstring, int> wordCount;
 
     // Разбиваем текст на слова и считаем частоту слов
@@ -126,29 +235,590 @@ std::vector<std::pair<std::wstring, int>> zipfsLaw(const std::wstring& text) {
         }
     }
 
-    // Вектор для хранения пар слово-частота
+    return rankFrequencies(wordCount, top);
+}
+
+// Частоты нормализованных слов: различные слова хранятся один раз в StringPool, 
+// частоты - в массиве по идентификаторам слов (повторное слово не выделяет память)
+struct WordCounts {
+    StringPool words; // Различные слова в UTF-8
+    std::vector<int> counts; // Частота слова по его идентификатору
+
+    void add(std::string_view word, int count = 1) {
+        uint32_t id = words.intern(word);
+        if (id == counts.size()) {
+            counts.push_back(0);
+        }
+        counts[id] += count;
+    }
+};
+
+// Переводит различные слова в wstring и сортирует в порядке рангов
+std::vector<std::pair<std::wstring, int>> rankWordCounts(const WordCounts& local, size_t top = 0) {
+    std::unordered_map<std::wstring, int> wordCount;
+    wordCount.reserve(local.counts.size());
+    for (uint32_t id = 0; id < local.counts.size(); ++id) {
+        wordCount.emplace(decodeUtf8(local.words.view(id)), local.counts[id]);
+    }
+    return rankFrequencies(wordCount, top);
+}
+
+/// <summary> 
+/// Закон Ципфа для текста в UTF-8 без перекодирования в wstring. 
+/// Токены нормализует Utf8Tokenizer (те же правила, что в zipfsLaw) прямо по байтам текста, 
+/// частоты копятся в WordCounts. В wstring переводятся только различные слова в конце. 
+/// Результат совпадает с zipfsLaw для того же текста. 
+/// </summary> 
+/// <param name="text">Текст в UTF-8</param> 
+/// <param name="top">Сколько первых рангов вернуть (0 - все слова)</param> 
+/// <returns>vector<pair<wstring, int>> - отсортированный по убыванию массив из пар (слово, частота)</returns> 
+std::vector<std::pair<std::wstring, int>> zipfsLawUtf8(std::string_view text, size_t top = 0) {
+    WordCounts local;
+    Utf8Tokenizer tokenizer;
+    tokenizer.tokenize(text, [&local](std::string_view token) {
+        local.add(token);
+    });
+    return rankWordCounts(local, top);
+}
+
+// Запускает fn(0), ..., fn(count - 1) в отдельных потоках и ждёт их завершения
+template <typename Function>
+void runOnThreads(unsigned count, Function fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        workers.emplace_back(fn, i);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/// <summary> 
+/// Многопоточный закон Ципфа для текста в UTF-8. 
+/// 1. Текст делится на threads фрагментов по ASCII-пробелам (токен никогда не разрезается), 
+///    каждый поток считает свой фрагмент в собственной таблице WordCounts, без общих блокировок. 
+/// 2. Слияние - параллельная редукция по хешу слова: поток p собирает из всех локальных таблиц 
+///    только слова своей части (хеш % threads == p), поэтому части не пересекаются, 
+///    и сразу сортирует свою часть в порядке рангов (при top > 0 - только top лучших слов части). 
+/// 3. Отсортированные части попарно сливаются (std::inplace_merge) в параллельных раундах. 
+/// Порядок рангов полный (frequencyOrder), поэтому результат в точности совпадает с zipfsLawUtf8 и zipfsLaw. 
+/// </summary> 
+/// <param name="text">Текст в UTF-8</param> 
+/// <param name="threads">Количество потоков (0 - по числу ядер)</param> 
+/// <param name="top">Сколько первых рангов вернуть (0 - все слова)</param> 
+/// <returns>vector<pair<wstring, int>> - отсортированный по убыванию массив из пар (слово, частота)</returns> 
+std::vector<std::pair<std::wstring, int>> zipfsLawParallel(std::string_view text, unsigned threads = 0, size_t top = 0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads == 1) {
+        return zipfsLawUtf8(text, top);
+    }
+
+    // Границы фрагментов сдвигаются вперёд до ближайшего разделителя токенизатора
+    std::vector<size_t> bounds(1, 0);
+    for (unsigned k = 1; k < threads; ++k) {
+        size_t position = std::max(bounds.back(), text.size() / threads * k);
+        while (position < text.size() && !Utf8Tokenizer::isAsciiSpace(text[position])) {
+            position++;
+        }
+        bounds.push_back(position);
+    }
+    bounds.push_back(text.size());
+
+    // 1. Подсчёт фрагментов; для каждого слова сразу запоминается номер его части
+    std::vector<std::unique_ptr<WordCounts>> locals(threads);
+    std::vector<std::vector<uint32_t>> partOf(threads);
+    runOnThreads(threads, [&](unsigned t) {
+        locals[t].reset(new WordCounts());
+        Utf8Tokenizer tokenizer;
+        WordCounts& local = *locals[t];
+        tokenizer.tokenize(text.substr(bounds[t], bounds[t + 1] - bounds[t]), [&local](std::string_view token) {
+            local.add(token);
+        });
+        partOf[t].resize(local.counts.size());
+        for (uint32_t id = 0; id < local.counts.size(); ++id) {
+            partOf[t][id] = static_cast<uint32_t>(mix64(std::hash<std::string_view>()(local.words.view(id))) % threads);
+        }
+    });
+
+    // 2. Параллельное слияние по частям и сортировка каждой части
+    std::vector<std::vector<std::pair<std::wstring, int>>> parts(threads);
+    runOnThreads(threads, [&](unsigned p) {
+        std::unordered_map<std::string_view, int> merged;
+        for (unsigned t = 0; t < threads; ++t) {
+            for (uint32_t id = 0; id < locals[t]->counts.size(); ++id) {
+                if (partOf[t][id] == p) {
+                    merged[locals[t]->words.view(id)] += locals[t]->counts[id];
+                }
+            }
+        }
+        parts[p].reserve(merged.size());
+        for (const auto& pair : merged) {
+            parts[p].emplace_back(decodeUtf8(pair.first), pair.second);
+        }
+        keepTopFrequencies(parts[p], top);
+    });
+
+    // 3. Попарное слияние отсортированных частей
     std::vector<std::pair<std::wstring, int>> frequencies;
-    for (const auto& pair : wordCount) {
-        frequencies.emplace_back(pair.first, pair.second);
+    std::vector<size_t> runs(1, 0);
+    for (auto& part : parts) {
+        frequencies.insert(frequencies.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+        runs.push_back(frequencies.size());
+        std::vector<std::pair<std::wstring, int>>().swap(part);
+    }
+    while (runs.size() > 2) {
+        size_t runCount = runs.size() - 1;
+        std::vector<size_t> next(1, 0);
+        for (size_t r = 0; r + 1 < runCount; r += 2) {
+            next.push_back(runs[r + 2]);
+        }
+        if (runCount % 2 == 1) {
+            next.push_back(runs[runCount]);
+        }
+        runOnThreads(static_cast<unsigned>(runCount / 2), [&](unsigned pair) {
+            auto begin = frequencies.begin();
+            std::inplace_merge(begin + runs[2 * pair], begin + runs[2 * pair + 1], begin + runs[2 * pair + 2], frequencyOrder);
+        });
+        runs.swap(next);
     }
+    if (top > 0 && top < frequencies.size()) {
+        frequencies.erase(frequencies.begin() + top, frequencies.end());
+    }
+    return frequencies;
+}
 
-    // Сортируем вектор по частоте
-    std::sort(frequencies.begin(), frequencies.end(), [](const auto& a, const auto& b) {
-        return a.second > b.second; // Сортировка по убыванию частоты
+/// <summary> 
+/// Закон Ципфа для UTF-8 файла без загрузки его в wstring. 
+/// Файл отображается в память (MappedFile) и разбирается zipfsLawUtf8 прямо по отображённым байтам. 
+/// Память - сам файл (страницы кеша ОС) и таблица различных слов. 
+/// Результат совпадает с zipfsLaw(readTextFromFile(filename)). 
+/// </summary> 
+/// <param name="filename">Путь к UTF-8 файлу</param> 
+/// <param name="threads">Количество потоков (1 - однопоточно, 0 - по числу ядер)</param> 
+/// <param name="top">Сколько первых рангов вернуть (0 - все слова)</param> 
+/// <returns>vector<pair<wstring, int>> - отсортированный по убыванию массив из пар (слово, частота)</returns> 
+std::vector<std::pair<std::wstring, int>> zipfsLawFromFile(const std::string& filename, unsigned threads = 1, size_t top = 0) {
+    MappedFile file(filename);
+    return zipfsLawParallel(std::string_view(file.data(), file.size()), threads, top);
+}
+
+
+/// <summary> 
+/// Потоковый подсчёт закона Ципфа с ограниченной памятью. 
+/// Текст в UTF-8 подаётся блоками любого размера через feed(); в памяти остаются только таблица 
+/// различных слов и хвост последнего блока после его последнего ASCII-пробела - начало токена, 
+/// продолжение которого придёт в следующем блоке (разрезанные многобайтовые символы UTF-8 
+/// тоже попадают в хвост, так как блок режется только по пробелам). 
+/// finish() дочитывает хвост и возвращает тот же результат, что zipfsLawUtf8 для всего текста. 
+/// Приближённый режим (counters > 0) вместо таблицы всех слов ведёт SpaceSaving из counters 
+/// счётчиков: память фиксирована и для бесконечного потока, частые слова находятся гарантированно, 
+/// а их частоты завышены не больше чем на (число слов) / counters. 
+/// С sketchWidth > 0 рядом ведётся CountMinSketch: SpaceSaving отбирает частые слова, а их частота - 
+/// меньшая из двух оценок сверху, что уточняет завышенные счётчики вытеснявших друг друга слов. 
+/// </summary> 
+class ZipfCounter {
+private:
+    static const size_t sketchDepth = 4; // Строк CountMinSketch (вероятность ошибки e^-4)
+
+    Utf8Tokenizer tokenizer;
+    WordCounts local; // Частоты слов
+    std::unique_ptr<SpaceSaving<std::string>> heavyHitters; // Счётчики приближённого режима
+    std::unique_ptr<CountMinSketch<std::string>> sketch; // Уточняющий скетч приближённого режима
+    std::string word; // Буфер ключа для heavyHitters
+    std::string carry; // Незавершённый токен с конца предыдущего блока
+
+    void count(std::string_view text) {
+        if (heavyHitters) {
+            tokenizer.tokenize(text, [this](std::string_view token) {
+                word.assign(token.data(), token.size());
+                heavyHitters->add(word);
+                if (sketch) {
+                    sketch->add(word);
+                }
+            });
+            return;
+        }
+        tokenizer.tokenize(text, [this](std::string_view token) {
+            local.add(token);
         });
+    }
 
-    return frequencies; // Возвращаем отсортированный вектор
+public:
+    /// <param name="counters">0 - точный подсчёт; иначе число счётчиков приближённого режима</param> 
+    /// <param name="sketchWidth">0 - без скетча; иначе ширина строки CountMinSketch (только вместе с counters)</param> 
+    explicit ZipfCounter(size_t counters = 0, size_t sketchWidth = 0) {
+        if (sketchWidth > 0 && counters == 0) {
+            throw std::invalid_argument("Count-Min sketch requires heavy-hitter counters");
+        }
+        if (counters > 0) {
+            heavyHitters.reset(new SpaceSaving<std::string>(counters));
+        }
+        if (sketchWidth > 0) {
+            sketch.reset(new CountMinSketch<std::string>(sketchWidth, sketchDepth));
+        }
+    }
+
+    /// <summary> 
+    /// Учитывает очередной блок текста. 
+    /// </summary> 
+    /// <param name="chunk">Блок UTF-8 текста (может начинаться и заканчиваться посреди токена)</param> 
+    void feed(std::string_view chunk) {
+        size_t last = chunk.size();
+        while (last > 0 && !Utf8Tokenizer::isAsciiSpace(chunk[last - 1])) {
+            last--;
+        }
+        if (last == 0) { // Во всём блоке нет пробела - токен продолжается
+            carry.append(chunk.data(), chunk.size());
+            return;
+        }
+
+        size_t start = 0;
+        if (!carry.empty()) { // Дописываем к хвосту начало блока до первого пробела
+            while (!Utf8Tokenizer::isAsciiSpace(chunk[start])) {
+                start++;
+            }
+            carry.append(chunk.data(), start);
+            count(carry);
+            carry.clear();
+        }
+        count(chunk.substr(start, last - start));
+        carry.assign(chunk.data() + last, chunk.size() - last);
+    }
+
+    /// <summary> 
+    /// Завершает подсчёт: учитывает последний токен и возвращает частоты. 
+    /// Оценки SpaceSaving больше INT_MAX выводятся как INT_MAX. 
+    /// </summary> 
+    /// <param name="top">Сколько первых рангов вернуть (0 - все слова)</param> 
+    /// <param name="errors">Если не nullptr - погрешность каждого возвращённого ранга (0 при точном подсчёте)</param> 
+    /// <returns>vector<pair<wstring, int>> - отсортированный по убыванию массив из пар (слово, частота)</returns> 
+    std::vector<std::pair<std::wstring, int>> finish(size_t top = 0, std::vector<uint64_t>* errors = nullptr) {
+        count(carry);
+        carry.clear();
+        if (!heavyHitters) {
+            std::vector<std::pair<std::wstring, int>> frequencies = rankWordCounts(local, top);
+            if (errors != nullptr) {
+                errors->assign(frequencies.size(), 0);
+            }
+            return frequencies;
+        }
+
+        std::vector<std::pair<std::wstring, int>> frequencies;
+        std::unordered_map<std::wstring, uint64_t> bounds;
+        frequencies.reserve(heavyHitters->size());
+        heavyHitters->forEach([&](const std::string& key, uint64_t count, uint64_t error) {
+            if (sketch) { // Нижняя граница count - error сохраняется, верхняя - меньшая из оценок
+                uint64_t lower = count - error;
+                count = std::min(count, sketch->estimate(key));
+                error = count - lower;
+            }
+            std::wstring wordText = decodeUtf8(key);
+            frequencies.emplace_back(wordText, static_cast<int>(std::min<uint64_t>(count, INT_MAX)));
+            if (errors != nullptr) {
+                bounds.emplace(std::move(wordText), error);
+            }
+        });
+        keepTopFrequencies(frequencies, top);
+        if (errors != nullptr) {
+            errors->clear();
+            errors->reserve(frequencies.size());
+            for (const auto& pair : frequencies) {
+                errors->push_back(bounds[pair.first]);
+            }
+        }
+        return frequencies;
+    }
+};
+
+// Закон Ципфа для потока (например, std::cin или файл, открытый в двоичном режиме): читает блоками blockSize байт 
+// через ZipfCounter (counters > 0 - приближённо, частые слова за фиксированную память; sketchWidth > 0 - с уточнением 
+// CountMinSketch; errors - погрешности рангов, см. ZipfCounter::finish). Ошибка чтения - исключение runtime_error
+std::vector<std::pair<std::wstring, int>> zipfsLawFromStream(std::istream& input, size_t top = 0, size_t counters = 0,
+    std::vector<uint64_t>* errors = nullptr, size_t sketchWidth = 0, size_t blockSize = 1 << 20) {
+    ZipfCounter counter(counters, sketchWidth);
+    std::vector<char> block(blockSize);
+    while (input.read(block.data(), static_cast<std::streamsize>(block.size())) || input.gcount() > 0) {
+        counter.feed(std::string_view(block.data(), static_cast<size_t>(input.gcount())));
+    }
+    if (input.bad()) {
+        throw std::runtime_error("Cannot read input stream");
+    }
+    return counter.finish(top, errors);
+}
+
+/// <summary> 
+/// Ограничение памяти пакетной обработки: семафор на байты. 
+/// Файл занимает в бюджете оценку своей памяти (batchFileMemory), поток ждёт, пока бюджета хватит. 
+/// Общая таблица корпуса растёт от файла к файлу и занимает бюджет насовсем (charge). 
+/// Если бюджета не хватает даже одному файлу (файл больше бюджета или корпус его исчерпал), 
+/// файл всё равно запускается, когда других файлов в работе нет, - файлы идут по одному. 
+/// </summary> 
+class MemoryBudget {
+private:
+    std::mutex lock;
+    std::condition_variable released;
+    size_t limit; // Весь бюджет в байтах
+    size_t used = 0; // Занято байт (файлы в работе и корпус)
+    size_t active = 0; // Файлов в работе
+
+public:
+    explicit MemoryBudget(size_t bytes) : limit(bytes) {}
+
+    // Ждёт и занимает до bytes байт; возвращает занятое количество для release
+    size_t acquire(size_t bytes) {
+        size_t granted = std::min(bytes, limit);
+        std::unique_lock<std::mutex> guard(lock);
+        released.wait(guard, [this, granted] { return active == 0 || (used <= limit && granted <= limit - used); });
+        used += granted;
+        active++;
+        return granted;
+    }
+
+    void release(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            used -= bytes;
+            active--;
+        }
+        released.notify_all();
+    }
+
+    // Занимает bytes насовсем, без ожидания (память, которая не освобождается до конца обработки)
+    void charge(size_t bytes) {
+        std::lock_guard<std::mutex> guard(lock);
+        used += bytes;
+    }
+};
+
+// Настройки пакетного режима
+struct BatchOptions {
+    std::vector<std::string> inputs; // Файлы и каталоги (из каталогов берутся все .txt, рекурсивно)
+    std::string outputDirectory = "zipfsBatch";
+    unsigned jobs = 0; // 0 - по числу ядер
+    size_t memoryBudget = size_t(1) << 30; // Байт на одновременно обрабатываемые файлы и таблицу корпуса
+    size_t top = 0; // 0 - все слова
+    size_t counters = 0; // 0 - точный подсчёт
+    size_t sketchWidth = 0; // 0 - без CountMinSketch
+};
+
+// Оценка памяти на обработку одного файла. Точный подсчёт: отображение файла (1 размер) плюс таблица 
+// различных слов в UTF-8 и её копия в wstring (на обычном тексте не больше 3 размеров файла). 
+// Приближённый: блок чтения, счётчики SpaceSaving (ключ, узлы списков и индекс) и скетч
+size_t batchFileMemory(uint64_t fileSize, const BatchOptions& options) {
+    const uint64_t tableFactor = 3;
+    const uint64_t bytesPerCounter = 256;
+    uint64_t bytes;
+    if (options.counters > 0) {
+        bytes = (uint64_t(1) << 20) + options.counters * bytesPerCounter + options.sketchWidth * 4 * sizeof(uint64_t);
+    }
+    else {
+        bytes = fileSize > UINT64_MAX / (tableFactor + 1) ? UINT64_MAX : fileSize * (tableFactor + 1);
+    }
+    return static_cast<size_t>(std::min<uint64_t>(bytes, SIZE_MAX));
+}
+
+// Память слова в таблице корпуса: символы, узел unordered_map и его место в корзинах
+size_t corpusEntryMemory(const std::wstring& word) {
+    return word.capacity() * sizeof(wchar_t) + sizeof(std::pair<const std::wstring, int>) + 3 * sizeof(void*);
+}
+
+/// <summary> 
+/// Пакетный закон Ципфа для многих файлов за один запуск. 
+/// Файлы обрабатываются пулом из jobs потоков (каждый берёт следующий необработанный файл) 
+/// в пределах бюджета памяти MemoryBudget. Для каждого файла пишутся свои CSV и SVG, 
+/// его частоты добавляются в общую таблицу корпуса (corpus.csv, corpus.svg). 
+/// Имена результатов - имя файла без расширения; совпадающие (без учёта регистра, как в Windows) 
+/// и имя corpus получают суффикс _1, _2, ... 
+/// Ошибка в одном файле или входном каталоге выводится в cerr и не останавливает остальные. 
+/// </summary> 
+/// <returns>Количество файлов и входов, которые не удалось обработать</returns> 
+size_t zipfsLawBatch(const BatchOptions& options) {
+    namespace fs = std::filesystem;
+
+    size_t failedInputs = 0;
+    std::vector<fs::path> files;
+    for (const std::string& input : options.inputs) {
+        try {
+            if (fs::is_directory(input)) {
+                for (const auto& entry : fs::recursive_directory_iterator(input)) {
+                    if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                        files.push_back(entry.path());
+                    }
+                }
+            }
+            else {
+                files.push_back(input);
+            }
+        }
+        catch (const fs::filesystem_error& error) {
+            std::cerr << input << ": " << error.what() << std::endl;
+            failedInputs++;
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::error_code directoryError;
+    fs::create_directories(options.outputDirectory, directoryError);
+    if (directoryError) {
+        std::cerr << options.outputDirectory << ": " << directoryError.message() << std::endl;
+        return files.size() + failedInputs + 1;
+    }
+
+    // Имена результатов: имя файла без расширения, занятые имена получают номер
+    auto foldCase = [](std::string name) {
+        for (char& c : name) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return name;
+    };
+    std::vector<std::string> names(files.size());
+    std::unordered_set<std::string> taken = { "corpus" };
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::string stem = files[i].stem().string();
+        std::string name = stem;
+        for (int repeat = 1; !taken.insert(foldCase(name)).second; ++repeat) {
+            name = stem + "_" + std::to_string(repeat);
+        }
+        names[i] = name;
+    }
+
+    MemoryBudget budget(options.memoryBudget);
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> failed(0);
+    std::mutex corpusLock;
+    std::unordered_map<std::wstring, int> corpus; // Частоты по всем файлам
+
+    unsigned jobs = options.jobs != 0 ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+    jobs = static_cast<unsigned>(std::min<size_t>(jobs, std::max<size_t>(files.size(), 1)));
+    runOnThreads(jobs, [&](unsigned) {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            const fs::path& file = files[i];
+            size_t granted = 0;
+            bool acquired = false;
+            try {
+                granted = budget.acquire(batchFileMemory(fs::file_size(file), options));
+                acquired = true;
+                std::vector<std::pair<std::wstring, int>> frequencies;
+                std::vector<uint64_t> errors; // Погрешности приближённого подсчёта
+                if (options.counters > 0) {
+                    std::ifstream input(file, std::ios::binary);
+                    if (!input) {
+                        throw std::runtime_error("Cannot open file: " + file.string());
+                    }
+                    frequencies = zipfsLawFromStream(input, 0, options.counters, &errors, options.sketchWidth);
+                }
+                else {
+                    frequencies = zipfsLawFromFile(file.string());
+                }
+                size_t corpusGrowth = 0;
+                {
+                    std::lock_guard<std::mutex> guard(corpusLock);
+                    for (const auto& pair : frequencies) {
+                        auto inserted = corpus.emplace(pair.first, 0);
+                        inserted.first->second += pair.second;
+                        if (inserted.second) {
+                            corpusGrowth += corpusEntryMemory(pair.first);
+                        }
+                    }
+                }
+                budget.charge(corpusGrowth);
+                if (options.top > 0 && options.top < frequencies.size()) {
+                    frequencies.resize(options.top);
+                    errors.resize(std::min(errors.size(), options.top));
+                }
+                fs::path output = fs::path(options.outputDirectory) / names[i];
+                writeFrequenciesToFile(frequencies, output.string() + ".csv", options.counters > 0 ? &errors : nullptr);
+                createSvg(frequencies, "ZIPF of " + names[i], output.string() + ".svg");
+            }
+            catch (const std::exception& error) {
+                std::cerr << file.string() << ": " << error.what() << std::endl;
+                failed++;
+            }
+            if (acquired) {
+                budget.release(granted);
+            }
+        }
+    });
+
+    std::vector<std::pair<std::wstring, int>> total = rankFrequencies(corpus, options.top);
+    fs::path output = fs::path(options.outputDirectory) / "corpus";
+    writeFrequenciesToFile(total, output.string() + ".csv");
+    createSvg(total, "ZIPF of corpus", output.string() + ".svg");
+    std::cout << "Processed " << files.size() - failed << " of " << files.size() << " files" << std::endl;
+    return failed + failedInputs;
 }
 
+// Чтение положительного числа из аргумента командной строки
+bool parseCount(const char* text, size_t& value) {
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || parsed == 0) {
+        return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+}
 
 // можно возращать просто словарь(или pair) а не структуру для того, чтобы использовать можно было хоть кому. + подгрузку с файла
 // проетестировать блоьшой текст в ципфе
 
-int main() {
+// Запуск:
+//   HashTable            - анализ input.txt
+//   HashTable --stdin    - анализ текста из стандартного ввода (например, cat corpus.txt.gz | gzip -d | HashTable --stdin)
+//   HashTable --top K    - в выводе только K первых рангов (без сортировки всего словаря)
+//   HashTable --heavy-hitters M - приближённые частоты частых слов на M счётчиках (Space-Saving), память не зависит от текста;
+//                        в CSV добавляется столбец Погрешность (истинная частота не меньше частоты минус погрешность)
+//   HashTable --heavy-hitters M --sketch W - то же, но частоты уточняются CountMinSketch из 4 строк по W счётчиков
+//   HashTable --batch PATH... [--jobs N] [--memory-mb N] [--output DIR] 
+//                        - пакетная обработка файлов и каталогов (.txt): CSV и SVG на файл и общая таблица corpus.csv
+int main(int argc, char* argv[]) {
 
     // Установка локали для корректного вывода широких символов
     std::locale::global(std::locale("")); // Использует системную локаль
 
+    bool fromStdin = false;
+    size_t top = 0; // 0 - все слова
+    size_t counters = 0; // 0 - точный подсчёт
+    size_t sketchWidth = 0; // 0 - без CountMinSketch
+    bool batch = false;
+    BatchOptions batchOptions;
+    size_t jobs = 0;
+    size_t memoryMb = batchOptions.memoryBudget >> 20;
+    std::string batchOnly; // Заданный параметр пакетного режима (--jobs, --memory-mb, --output)
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--jobs" || option == "--memory-mb" || option == "--output") {
+            batchOnly = option;
+        }
+        if (option == "--stdin") {
+            fromStdin = true;
+        }
+        else if (option == "--batch") {
+            batch = true;
+        }
+        else if ((option == "--top" || option == "--heavy-hitters" || option == "--sketch" || option == "--jobs" || option == "--memory-mb") && i + 1 < argc) {
+            size_t& value = option == "--top" ? top : option == "--heavy-hitters" ? counters : option == "--sketch" ? sketchWidth
+                : option == "--jobs" ? jobs : memoryMb;
+            if (!parseCount(argv[++i], value)) {
+                std::cerr << option << " expects a positive number, got: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (option == "--output" && i + 1 < argc) {
+            batchOptions.outputDirectory = argv[++i];
+        }
+        else if (batch && option.compare(0, 2, "--") != 0) {
+            batchOptions.inputs.push_back(option);
+        }
+        else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+
     // Чтение текста из файла
     
     // Aldous_Huxley_-_Brave_New_World
@@ -159,17 +829,63 @@ int main() {
 
     // Kalinin_Proekt-S-T-A-L-K-E-R-_1_Teni-Chernobylya_RuLit_Me
     
-    std::wstring wideText = readTextFromFile("input.txt");
     string titleOfSvg = "ZIPF of Kalinin_Proekt-S-T-A-L-K-E-R-_1_Teni-Chernobylya_RuLit_Me";
 
-    // Анализ текста с помощью закона Ципфа
-    auto frequencies = zipfsLaw(wideText);
+    if (sketchWidth > 0 && counters == 0) {
+        std::cerr << "--sketch requires --heavy-hitters" << std::endl;
+        return 1;
+    }
+    if (!batch && !batchOnly.empty()) {
+        std::cerr << batchOnly << " requires --batch" << std::endl;
+        return 1;
+    }
+
+    if (batch) {
+        if (batchOptions.inputs.empty()) {
+            std::cerr << "--batch expects files or directories" << std::endl;
+            return 1;
+        }
+        if (fromStdin) {
+            std::cerr << "--stdin cannot be combined with --batch" << std::endl;
+            return 1;
+        }
+        if (memoryMb > (SIZE_MAX >> 20)) {
+            std::cerr << "--memory-mb is too large: " << memoryMb << std::endl;
+            return 1;
+        }
+        batchOptions.jobs = static_cast<unsigned>(jobs);
+        batchOptions.memoryBudget = memoryMb << 20;
+        batchOptions.top = top;
+        batchOptions.counters = counters;
+        batchOptions.sketchWidth = sketchWidth;
+        return zipfsLawBatch(batchOptions) == 0 ? 0 : 1;
+    }
+
+    std::vector<std::pair<std::wstring, int>> frequencies;
+    std::vector<uint64_t> errors; // Погрешности приближённого подсчёта (--heavy-hitters)
+    if (fromStdin) {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY); // Без преобразования \r\n и остановки на Ctrl+Z
+#endif
+        titleOfSvg = "ZIPF of stdin";
+        frequencies = zipfsLawFromStream(std::cin, top, counters, &errors, sketchWidth);
+    }
+    else if (counters > 0) {
+        std::ifstream input("input.txt", std::ios::binary);
+        if (!input) {
+            std::cerr << "Cannot open input.txt" << std::endl;
+            return 1;
+        }
+        frequencies = zipfsLawFromStream(input, top, counters, &errors, sketchWidth);
+    }
+    else {
+        // Анализ текста с помощью закона Ципфа (файл отображается в память, подсчёт на всех ядрах)
+        frequencies = zipfsLawFromFile("input.txt", 0, top);
+    }
 
     // Запись результатов в файл
-    writeFrequenciesToFile(frequencies, "zipfsOutput.csv");
+    writeFrequenciesToFile(frequencies, "zipfsOutput.csv", counters > 0 ? &errors : nullptr);
     createSvg(frequencies, titleOfSvg);
 
     return 0;
 }
-
-
@@ -1,4 +1,5 @@
-﻿#include <iostream>
+﻿#pragma once
+#include <iostream>
 #include <vector>
 #include <list>
 #include <functional>
@@ -6,6 +7,11 @@
 #include <cassert>
 #include <algorithm>
 #include <string>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
 
 using namespace std;
 
@@ -75,6 +81,81 @@ size_t murmurHash(const Key& key) {
     return hash; // Возвращаем окончательный хеш
 }
 
+/// <summary> 
+/// Финализатор MurmurHash3 (fmix64): биективно перемешивает биты 64-битного числа. 
+/// Используется intMixHash и keyHash64 (хеш вероятностных структур). 
+/// </summary> 
+/// <param name="x">Число для перемешивания</param> 
+/// <returns>Перемешанное 64-битное значение</returns>
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL; // Константы финализатора MurmurHash3
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/// <summary> 
+/// Перемешивающая функция для целочисленных ключей (финализатор MurmurHash3 / SplitMix64). 
+/// Биективна на 64-битных числах: разные ключи никогда не дают одинаковый хеш до взятия остатка, 
+/// а каждый бит ключа влияет на все биты результата. Работает за несколько умножений и сдвигов, 
+/// без побайтового цикла (в отличие от djb2Hash, которая останавливается на первом нулевом байте).
+/// </summary> 
+/// <typeparam name="Key">Целочисленный тип ключа</typeparam> 
+/// <param name="key">Ключ для хеширования</param> 
+/// <returns>Хеш-значение для данного ключа</returns>
+template <typename Key>
+size_t intMixHash(const Key& key) {
+    return static_cast<size_t>(mix64(static_cast<uint64_t>(key)));
+}
+
+/// <summary>
+/// Стабильный хеш FNV-1a (64 бита) по байтам. В отличие от fnv1aHash
+/// не зависит от std::hash, поэтому одинаков во всех сборках и годится для файлов.
+/// </summary>
+inline uint64_t stableBytesHash(const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <typename T>
+struct IsBasicString : std::false_type {};
+
+template <typename CharT, typename Traits, typename Allocator>
+struct IsBasicString<std::basic_string<CharT, Traits, Allocator>> : std::true_type {};
+
+template <typename CharT, typename Traits>
+struct IsBasicString<std::basic_string_view<CharT, Traits>> : std::true_type {};
+
+/// <summary> 
+/// 64-битный хеш ключа для вероятностных структур (фильтров, скетчей, HyperLogLog, MinHash), 
+/// которым нужны все 64 бита и на 32-битной платформе (например, две независимые половины хеша): 
+/// - целые числа и перечисления - mix64 от значения (биективно); 
+/// - строки - stableBytesHash по символам, перемешанный mix64; 
+/// - остальные типы - fnv1aHash, перемешанный mix64: там, где size_t 32-битный, в хеше только 32 бита энтропии. 
+/// </summary> 
+/// <typeparam name="Key">Тип ключа</typeparam> 
+/// <param name="key">Ключ для хеширования</param> 
+/// <returns>Перемешанное 64-битное значение</returns>
+template <typename Key>
+uint64_t keyHash64(const Key& key) {
+    if constexpr (std::is_integral<Key>::value || std::is_enum<Key>::value) {
+        return mix64(static_cast<uint64_t>(key));
+    }
+    else if constexpr (IsBasicString<Key>::value) {
+        return mix64(stableBytesHash(key.data(), key.size() * sizeof(typename Key::value_type)));
+    }
+    else {
+        return mix64(static_cast<uint64_t>(fnv1aHash<Key>(key)));
+    }
+}
+
 /// <summary>
 /// Легкая функция для тестирования коллизий
 /// </summary>
@@ -106,6 +187,7 @@ private:
     double loadFactor; // Коэффициент заполнения
     double maxLoadFactor; // Максимальный коэффициент загрузки
     double minLoadFactor; // Минимальный коэффициент загрузки
+    size_t minCapacity = 10; // Ёмкость, ниже которой таблица не уменьшается (растёт после reserve)
 
     /// <summary> 
     /// Вычисляет индекс в таблице на основе хеш-значения ключа. 
@@ -131,18 +213,7 @@ private:
     /// Это необходимо для оптимизации хранения элементов при превышении максимального коэффициента загрузки. 
     /// </remarks>
     void resizeUp() {
-        size_t newCapacity = table.size() * 2;
-        std::vector<std::list<Key>> newTable(newCapacity);
-
-        // Переносим все элементы в новую таблицу
-        for (const auto& bucket : table) {
-            for (const auto& key : bucket) {
-                size_t newIndex = hashFunction(key) % newCapacity;
-                newTable[newIndex].push_back(key);
-            }
-        }
-
-        table.swap(newTable); // Обновляем таблицу
+        rehash(table.size() * 2);
     }
 
 
@@ -156,17 +227,29 @@ private:
     /// </remarks>
     void resizeDown() {
         size_t newCapacity = table.size() / 2; // Уменьшаем емкость вдвое
-        if (newCapacity < 10) {  // Ограничение минимальной емкости
-            newCapacity = 10;    // Если новый размер становится меньше минимальной емкости - ничего не делаем
-            return;
+        if (newCapacity < minCapacity) {  // Ограничение минимальной емкости
+            return;    // Если новый размер становится меньше минимальной емкости - ничего не делаем
         }
+        rehash(newCapacity);
+    }
+
+    /// <summary> 
+    /// Переносит все элементы в новую таблицу заданной емкости. 
+    /// BigO: O(n)
+    /// </summary> 
+    /// <remarks> 
+    /// Узлы списков переносятся через splice, без копирования элементов, 
+    /// поэтому указатели на элементы (например, из findByHash) остаются действительными. 
+    /// </remarks>
+    /// <param name="newCapacity">Новое количество ведер.</param>
+    void rehash(size_t newCapacity) {
         std::vector<std::list<Key>> newTable(newCapacity);
 
         // Переносим все элементы в новую таблицу
-        for (const auto& bucket : table) {
-            for (const auto& key : bucket) {
-                size_t newIndex = hashFunction(key) % newCapacity;
-                newTable[newIndex].push_back(key);
+        for (auto& bucket : table) {
+            while (!bucket.empty()) {
+                size_t newIndex = hashFunction(bucket.front()) % newCapacity;
+                newTable[newIndex].splice(newTable[newIndex].end(), bucket, bucket.begin());
             }
         }
 
@@ -182,7 +265,7 @@ public:
     /// <param name="maxLoad">Максимальный коэффициент загрузки (по умолчанию 0.7).</param>
     /// <param name="maxLoad">Минимальный коэффициент загрузки (по умолчанию 0.3).</param>  
     HashTable(std::function<size_t(const Key&)> hashFunc, size_t capacity = 10, double maxLoad = 0.7, double minLoad = 0.3)
-        : _size(0), maxLoadFactor(maxLoad), minLoadFactor(minLoad), hashFunction(hashFunc) {
+        : _size(0), loadFactor(0), maxLoadFactor(maxLoad), minLoadFactor(minLoad), hashFunction(hashFunc) {
         table.resize(capacity);
     }
 
@@ -212,6 +295,47 @@ public:
         }
     }
 
+    class Iterator;
+
+    /// <summary> 
+    /// Добавляет элемент, только если его ещё нет в таблице. 
+    /// Хеш вычисляется один раз, ведро просматривается один раз: 
+    /// если элемент найден, возвращается итератор на него, иначе элемент дописывается в это же ведро. 
+    /// BigO: Average - O(1), Worst - O(2n)
+    /// </summary> 
+    /// <param name="key">Ключ, который необходимо добавить в таблицу.</param> 
+    /// <returns>Пара (итератор на элемент в таблице, true если элемент был добавлен).</returns>
+    std::pair<Iterator, bool> insertUnique(const Key& key) {
+        size_t hash = hashFunction(key);
+        size_t index = hash % table.size();
+        auto& bucket = table[index];
+        for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+            if (*it == key) {
+                return std::make_pair(Iterator(*this, index, it), false);
+            }
+        }
+
+        // Проверяем необходимость увеличения размера таблицы
+        if (loadFactor >= maxLoadFactor) {
+            resizeUp();
+            index = hash % table.size();
+        }
+
+        table[index].push_back(key);
+        _size++;
+        loadFactor = static_cast<double>(_size) / table.size();
+
+        // Как и в insert, таблица может уменьшиться (например, после clear), тогда элемент ищется заново
+        if (loadFactor < minLoadFactor && table.size() > 10) {
+            resizeDown();
+            index = hash % table.size();
+            auto it = std::find(table[index].begin(), table[index].end(), key);
+            return std::make_pair(Iterator(*this, index, it), true);
+        }
+
+        return std::make_pair(Iterator(*this, index, std::prev(table[index].end())), true);
+    }
+
     /// <summary> 
     /// Проверяет, существует ли указанный элемент в таблице. 
     /// BigO: Average - O(1), Worst - O(n)
@@ -257,6 +381,89 @@ public:
         throw std::runtime_error("Key not found");
     }
 
+    /// <summary> 
+    /// Ищет элемент по заранее вычисленному хешу и предикату. 
+    /// Просматривается только ведро hash % capacity(), поэтому hash должен совпадать 
+    /// с hashFunction(element) для искомого элемента. Позволяет искать по части элемента 
+    /// (например, по ключу пары), не создавая элемент целиком. 
+    /// BigO: Average - O(1), Worst - O(n)
+    /// </summary> 
+    /// <param name="hash">Хеш искомого элемента.</param> 
+    /// <param name="matches">Предикат, возвращающий true для искомого элемента.</param> 
+    /// <returns>Указатель на найденный элемент или nullptr.</returns>
+    template <typename Predicate>
+    Key* findByHash(size_t hash, Predicate matches) {
+        for (auto& item : table[hash % table.size()]) {
+            if (matches(item)) {
+                return &item;
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename Predicate>
+    const Key* findByHash(size_t hash, Predicate matches) const {
+        for (const auto& item : table[hash % table.size()]) {
+            if (matches(item)) {
+                return &item;
+            }
+        }
+        return nullptr;
+    }
+
+    /// <summary> 
+    /// Добавляет элемент по заранее вычисленному хешу (без проверки на дубликат), перемещая его в таблицу. 
+    /// Вместе с findByHash позволяет сделать "найти или вставить" за одно вычисление хеша. 
+    /// BigO: Average - O(1), Worst - O(2n)
+    /// </summary> 
+    /// <param name="hash">Хеш элемента, должен совпадать с hashFunction(key).</param> 
+    /// <param name="key">Добавляемый элемент.</param> 
+    /// <returns>Указатель на элемент в таблице; остаётся действительным до удаления элемента.</returns>
+    Key* insertByHash(size_t hash, Key&& key) {
+        // Проверяем необходимость увеличения размера таблицы
+        if (loadFactor >= maxLoadFactor) {
+            resizeUp();
+        }
+
+        auto& bucket = table[hash % table.size()];
+        bucket.push_back(std::move(key));
+        Key* inserted = &bucket.back();
+        _size++;
+        loadFactor = static_cast<double>(_size) / table.size();
+
+        // Проверяем необходимость уменьшения размера таблицы (узлы не перемещаются, указатель действителен)
+        if (loadFactor < minLoadFactor && table.size() > 10) {
+            resizeDown();
+        }
+        return inserted;
+    }
+
+    /// <summary> 
+    /// Удаляет первый элемент ведра hash % capacity(), для которого matches возвращает true. 
+    /// BigO: Average - O(1), Worst - O(n)
+    /// </summary> 
+    /// <param name="hash">Хеш удаляемого элемента.</param> 
+    /// <param name="matches">Предикат, возвращающий true для удаляемого элемента.</param> 
+    /// <returns>true, если элемент был найден и удалён.</returns>
+    template <typename Predicate>
+    bool removeByHash(size_t hash, Predicate matches) {
+        auto& bucket = table[hash % table.size()];
+        for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+            if (matches(*it)) {
+                bucket.erase(it);
+                _size--;
+                loadFactor = static_cast<double>(_size) / table.size();
+
+                // Проверяем необходимость уменьшения размера таблицы
+                if (loadFactor < minLoadFactor && table.size() > 10) {
+                    resizeDown();
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
     /// <summary> 
     /// Возвращает текущее количество элементов в таблице. 
     /// </summary> 
@@ -297,6 +504,39 @@ public:
         return minLoadFactor;
     }
 
+    /// <summary> 
+    /// Резервирует место под n элементов: увеличивает число ведер так, чтобы вставка n элементов 
+    /// не вызывала resizeUp, и запрещает resizeDown ниже этой емкости. 
+    /// BigO: O(n)
+    /// </summary> 
+    /// <param name="n">Ожидаемое количество элементов.</param>
+    void reserve(size_t n) {
+        size_t needed = static_cast<size_t>(n / maxLoadFactor) + 1;
+        if (needed > minCapacity) {
+            minCapacity = needed;
+        }
+        if (needed > table.size()) {
+            rehash(needed);
+            loadFactor = static_cast<double>(_size) / table.size();
+        }
+    }
+
+    /// <summary> 
+    /// Обходит элементы ведер с индексами [firstBucket, lastBucket). 
+    /// Не изменяет таблицу, поэтому разные диапазоны ведер можно обходить из разных потоков одновременно. 
+    /// </summary> 
+    /// <param name="firstBucket">Первое ведро диапазона.</param> 
+    /// <param name="lastBucket">Ведро за последним в диапазоне (не больше capacity()).</param> 
+    /// <param name="visit">Функция, вызываемая для каждого элемента.</param>
+    template <typename Visitor>
+    void forEachInBuckets(size_t firstBucket, size_t lastBucket, Visitor visit) const {
+        for (size_t i = firstBucket; i < lastBucket; ++i) {
+            for (const auto& key : table[i]) {
+                visit(key);
+            }
+        }
+    }
+
     /// <summary> 
     /// Проверяет равенство двух ключей. 
     /// </summary> 
@@ -354,11 +594,20 @@ public:
             findNext(); // Ищем первый элемент
         }
 
+        /// <summary> 
+        /// Конструктор итератора, указывающего на конкретный элемент ведра. 
+        /// </summary> 
+        /// <param name="ht">Ссылка на хеш-таблицу.</param> 
+        /// <param name="index">Индекс ведра.</param> 
+        /// <param name="position">Позиция элемента в ведре.</param>
+        Iterator(HashTable& ht, size_t index, typename std::list<Key>::iterator position)
+            : hashTable(ht), bucketIndex(index), listIterator(position) {}
+
         /// <summary> 
         /// Доступ к текущему элементу, на который указывает итератор. 
         /// </summary> 
         /// <returns>Текущий ключ, на который указывает итератор.</returns>
-        Key operator*() const {
+        const Key& operator*() const {
             return *listIterator;
         }
 
@@ -383,6 +632,13 @@ public:
         bool operator!=(const Iterator& other) const {
             return (bucketIndex != other.bucketIndex || listIterator != other.listIterator);
         }
+
+        /// <summary> 
+        /// Проверяет равны ли два итератора. 
+        /// </summary> 
+        bool operator==(const Iterator& other) const {
+            return !(*this != other);
+        }
     };
 
     /// <summary> 
@@ -398,7 +654,8 @@ public:
     /// </summary> 
     /// <returns>Итератор, указывающий на "конец" хеш-таблицы (позиция за последним элементом).</returns>
     Iterator end() {
-        return Iterator(*this, table.size()-1);
+        // Итератор begin() после последнего элемента стоит за последним ведром, в конце его списка
+        return Iterator(*this, table.size(), table.back().end());
     }
 
     /// <summary>
@@ -0,0 +1,600 @@
+﻿#pragma once
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <iostream>
+#include "HashTable.h"
+
+/// <summary>
+/// Хеш-таблица (множество ключей), специализированная для целочисленных ключей.
+/// В отличие от HashTable, ключи хранятся прямо в плоском массиве (открытая адресация, линейное пробирование),
+/// без узлов std::list. Пустая ячейка помечается значением-стражем (максимальное значение типа),
+/// а сам ключ-страж, если его вставили, хранится отдельным флагом.
+/// Ёмкость всегда степень двойки, поэтому индекс вычисляется маской, а не делением.
+/// Хеш — intMixHash (биективное перемешивание), без побайтового цикла.
+/// При коэффициенте загрузки до 0.7 поиск обычно укладывается в одну кеш-линию:
+/// пробирование идёт по соседним ячейкам одного непрерывного массива.
+/// </summary>
+/// <typeparam name="Key">Целочисленный тип ключа</typeparam>
+template <typename Key>
+class IntHashTable {
+    static_assert(std::is_integral<Key>::value, "IntHashTable requires an integral key type");
+
+private:
+    std::vector<Key> slots; // Плоский массив ключей, пустые ячейки содержат emptyKey()
+    size_t mask; // capacity - 1, ёмкость - степень двойки
+    size_t _size; // Количество элементов в таблице (включая ключ-страж)
+    bool hasEmptyKey; // Вставлен ли ключ, совпадающий со стражем
+    double maxLoadFactor; // Максимальный коэффициент загрузки
+
+    /// <summary>
+    /// Значение-страж, которым помечаются пустые ячейки.
+    /// </summary>
+    static Key emptyKey() {
+        return std::numeric_limits<Key>::max();
+    }
+
+    /// <summary>
+    /// Наименьшая степень двойки, не меньшая n (но не меньше 16 - минимальная ёмкость).
+    /// </summary>
+    static size_t roundUpPow2(size_t n) {
+        size_t capacity = 16;
+        while (capacity < n) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    /// <summary>
+    /// Вычисляет "родной" индекс ключа в массиве.
+    /// </summary>
+    size_t homeIndex(const Key& key) const {
+        return intMixHash<Key>(key) & mask;
+    }
+
+    /// <summary>
+    /// Ищет ячейку с ключом. Пробирование идёт вперёд по непрерывному массиву до первой пустой ячейки.
+    /// </summary>
+    /// <returns>Индекс ячейки с ключом или slots.size(), если ключ не найден.</returns>
+    size_t findSlot(const Key& key) const {
+        const Key empty = emptyKey();
+        size_t index = homeIndex(key);
+        while (true) {
+            const Key current = slots[index];
+            if (current == key) {
+                return index;
+            }
+            if (current == empty) {
+                return slots.size();
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    /// <summary>
+    /// Перестраивает таблицу с новой ёмкостью.
+    /// BigO: O(n)
+    /// </summary>
+    void rehash(size_t newCapacity) {
+        std::vector<Key> oldSlots(newCapacity, emptyKey());
+        oldSlots.swap(slots);
+        mask = newCapacity - 1;
+
+        const Key empty = emptyKey();
+        for (const Key& key : oldSlots) {
+            if (key != empty) {
+                size_t index = homeIndex(key);
+                while (slots[index] != empty) {
+                    index = (index + 1) & mask;
+                }
+                slots[index] = key;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Количество ключей, лежащих в массиве (без ключа-стража).
+    /// </summary>
+    size_t storedCount() const {
+        return _size - (hasEmptyKey ? 1 : 0);
+    }
+
+public:
+    /// <summary>
+    /// Конструктор IntHashTable.
+    /// </summary>
+    /// <param name="capacity">Начальная ёмкость (округляется вверх до степени двойки, минимум 16).</param>
+    /// <param name="maxLoad">Максимальный коэффициент загрузки (по умолчанию 0.7).</param>
+    IntHashTable(size_t capacity = 16, double maxLoad = 0.7)
+        : mask(0), _size(0), hasEmptyKey(false), maxLoadFactor(maxLoad) {
+        size_t newCapacity = roundUpPow2(capacity);
+        slots.assign(newCapacity, emptyKey());
+        mask = newCapacity - 1;
+    }
+
+    class Iterator;
+
+    /// <summary>
+    /// Добавляет ключ в таблицу, если его ещё нет.
+    /// BigO: Average - O(1), Worst - O(n)
+    /// </summary>
+    /// <param name="key">Ключ, который необходимо добавить.</param>
+    /// <returns>true, если ключ был добавлен, false - если он уже был в таблице.</returns>
+    bool insert(const Key& key) {
+        return insertUnique(key).second;
+    }
+
+    /// <summary>
+    /// Добавляет ключ, если его ещё нет, за один проход пробирования.
+    /// BigO: Average - O(1), Worst - O(n)
+    /// </summary>
+    /// <returns>Пара (итератор на ключ в таблице, true если ключ был добавлен).
+    /// Итератор действителен до следующей вставки (перестроение перемещает ключи).</returns>
+    std::pair<Iterator, bool> insertUnique(const Key& key) {
+        if (key == emptyKey()) {
+            bool inserted = !hasEmptyKey;
+            if (inserted) {
+                hasEmptyKey = true;
+                _size++;
+            }
+            return std::make_pair(Iterator(*this, slots.size()), inserted);
+        }
+
+        if (static_cast<double>(storedCount() + 1) > maxLoadFactor * slots.size()) {
+            rehash(slots.size() * 2);
+        }
+
+        const Key empty = emptyKey();
+        size_t index = homeIndex(key);
+        while (true) {
+            const Key current = slots[index];
+            if (current == key) {
+                return std::make_pair(Iterator(*this, index), false);
+            }
+            if (current == empty) {
+                slots[index] = key;
+                _size++;
+                return std::make_pair(Iterator(*this, index), true);
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    /// <summary>
+    /// Проверяет, существует ли указанный ключ в таблице.
+    /// BigO: Average - O(1), Worst - O(n)
+    /// </summary>
+    /// <param name="key">Ключ, который необходимо проверить на наличие.</param>
+    /// <returns>Возвращает true, если ключ существует, в противном случае false.</returns>
+    bool contains(const Key& key) const {
+        if (key == emptyKey()) {
+            return hasEmptyKey;
+        }
+        return findSlot(key) != slots.size();
+    }
+
+    /// <summary>
+    /// Удаляет указанный ключ из таблицы.
+    /// BigO: Average - O(1), Worst - O(n)
+    /// </summary>
+    /// <param name="key">Ключ, который необходимо удалить.</param>
+    /// <remarks>
+    /// Удаление без "надгробий": следующие за ячейкой ключи сдвигаются назад (backward shift),
+    /// поэтому цепочки пробирования не удлиняются после удалений.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </remarks>
+    void remove(const Key& key) {
+        if (key == emptyKey()) {
+            if (!hasEmptyKey) {
+                throw std::runtime_error("Key not found");
+            }
+            hasEmptyKey = false;
+            _size--;
+            return;
+        }
+
+        size_t hole = findSlot(key);
+        if (hole == slots.size()) {
+            throw std::runtime_error("Key not found");
+        }
+
+        const Key empty = emptyKey();
+        size_t next = hole;
+        while (true) {
+            next = (next + 1) & mask;
+            if (slots[next] == empty) {
+                break;
+            }
+            // Ключ можно перенести в "дыру", если его родной индекс не лежит циклически в (hole, next]
+            size_t home = homeIndex(slots[next]);
+            bool stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+            if (!stays) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = empty;
+        _size--;
+    }
+
+    /// <summary>
+    /// Резервирует место под n ключей без перестроений при вставке.
+    /// </summary>
+    /// <param name="n">Ожидаемое количество ключей.</param>
+    void reserve(size_t n) {
+        size_t needed = roundUpPow2(static_cast<size_t>(n / maxLoadFactor) + 1);
+        if (needed > slots.size()) {
+            rehash(needed);
+        }
+    }
+
+    /// <summary>
+    /// Возвращает текущее количество элементов в таблице.
+    /// </summary>
+    size_t size() const {
+        return _size;
+    }
+
+    /// <summary>
+    /// Возвращает текущее capacity таблицы (количество ячеек массива).
+    /// </summary>
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    /// <summary>
+    /// Возвращает текущий коэффициент заполнения таблицы.
+    /// </summary>
+    double get_loadFactor() const {
+        return static_cast<double>(storedCount()) / slots.size();
+    }
+
+    /// <summary>
+    /// Возвращает максимальный коэффициент загрузки таблицы.
+    /// </summary>
+    double get_maxLoadFactor() const {
+        return maxLoadFactor;
+    }
+
+    /// <summary>
+    /// Метод очистки таблицы. Ёмкость сохраняется.
+    /// </summary>
+    void clear() {
+        std::fill(slots.begin(), slots.end(), emptyKey());
+        hasEmptyKey = false;
+        _size = 0;
+    }
+
+    class Iterator {
+    private:
+        const IntHashTable* hashTable; // Таблица, к которой относится итератор (указатель - итератор присваиваемый)
+        size_t position; // Индекс ячейки; позиция slots.size() обозначает ключ-страж
+
+        /// <summary>
+        /// Пропускает пустые ячейки (и позицию стража, если страж не вставлен).
+        /// </summary>
+        void findNext() {
+            const size_t capacity = hashTable->slots.size();
+            while (position < capacity && hashTable->slots[position] == emptyKey()) {
+                position++;
+            }
+            if (position == capacity && !hashTable->hasEmptyKey) {
+                position++;
+            }
+        }
+
+    public:
+        Iterator(const IntHashTable& ht, size_t start)
+            : hashTable(&ht), position(start) {
+            findNext();
+        }
+
+        Key operator*() const {
+            return position < hashTable->slots.size() ? hashTable->slots[position] : emptyKey();
+        }
+
+        Iterator& operator++() {
+            position++;
+            findNext();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return position == other.position;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return position != other.position;
+        }
+    };
+
+    /// <summary>
+    /// Возвращает итератор на начало таблицы.
+    /// </summary>
+    Iterator begin() const {
+        return Iterator(*this, 0);
+    }
+
+    /// <summary>
+    /// Возвращает итератор на конец таблицы (позиция за ключом-стражем).
+    /// </summary>
+    Iterator end() const {
+        return Iterator(*this, slots.size() + 1);
+    }
+
+    /// <summary>
+    /// Функция тестирования IntHashTable
+    /// </summary>
+    static void testIntHashTable() {
+        IntHashTable<int> table;
+        assert(table.size() == 0);
+        assert(table.insert(1));
+        assert(table.insert(2));
+        assert(table.insert(3));
+        assert(!table.insert(2)); // Дубликат не вставляется
+        auto probe = table.insertUnique(3);
+        assert(!probe.second && *probe.first == 3);
+        assert(table.size() == 3);
+        assert(table.contains(1));
+        assert(!table.contains(4));
+
+        // Ключи с нулевыми байтами и отрицательные ключи (djb2Hash на них вырождается)
+        assert(table.insert(0));
+        assert(table.insert(256));
+        assert(table.insert(-1));
+        assert(table.contains(0) && table.contains(256) && table.contains(-1));
+
+        // Ключ, совпадающий со стражем пустой ячейки
+        int sentinel = std::numeric_limits<int>::max();
+        assert(!table.contains(sentinel));
+        assert(table.insert(sentinel));
+        assert(table.contains(sentinel));
+        assert(table.size() == 7);
+
+        // Рост таблицы и удаление со сдвигом назад
+        for (int i = 100; i < 10100; ++i) {
+            table.insert(i);
+        }
+        assert(table.size() == 10006); // 256 уже был в таблице
+        assert(table.get_loadFactor() <= table.get_maxLoadFactor());
+        for (int i = 100; i < 10100; i += 2) {
+            table.remove(i);
+        }
+        for (int i = 100; i < 10100; ++i) {
+            assert(table.contains(i) == (i % 2 == 1));
+        }
+
+        try {
+            table.remove(100);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        // Итератор обходит все ключи ровно один раз, включая стража
+        size_t visited = 0;
+        bool sawSentinel = false;
+        for (auto it = table.begin(); it != table.end(); ++it) {
+            visited++;
+            if (*it == sentinel) {
+                sawSentinel = true;
+            }
+        }
+        assert(visited == table.size());
+        assert(sawSentinel);
+
+        table.remove(sentinel);
+        assert(!table.contains(sentinel));
+
+        table.clear();
+        assert(table.size() == 0);
+        assert(!table.contains(101));
+
+        // Беззнаковые ключи и reserve
+        IntHashTable<unsigned long long> big;
+        big.reserve(1000);
+        size_t capacityBefore = big.capacity();
+        for (unsigned long long i = 0; i < 1000; ++i) {
+            big.insert(i << 40);
+        }
+        assert(big.capacity() == capacityBefore); // reserve исключил перестроения
+        assert(big.contains(999ULL << 40));
+
+        std::cout << "All INT HASH tests passed!" << std::endl;
+    }
+};
+
+/// <summary>
+/// Множество целых чисел с тем же интерфейсом, что и Set, на основе IntHashTable:
+/// ключи лежат в плоском массиве с открытой адресацией вместо узлов std::list,
+/// поиск обычно трогает одну кеш-линию. Выбирается как SetOf<Value, SetBackend::OpenAddressing>
+/// из SetOf.h (для целочисленных типов это выбор SetOf по умолчанию).
+/// </summary>
+/// <typeparam name="Value">Целочисленный тип элемента</typeparam>
+template <typename Value>
+class IntSet {
+private:
+    IntHashTable<Value> table; // Плоская хеш-таблица элементов
+
+    /// <summary>
+    /// Собирает множество из элементов source, для которых keep возвращает true.
+    /// </summary>
+    template <typename Predicate>
+    static IntSet select(const IntSet& source, Predicate keep) {
+        IntSet result;
+        source.forEach([&result, &keep](const Value& value) {
+            if (keep(value)) {
+                result.table.insert(value);
+            }
+        });
+        return result;
+    }
+
+public:
+    using Iterator = typename IntHashTable<Value>::Iterator;
+
+    /// <summary>
+    /// Конструктор IntSet.
+    /// </summary>
+    /// <param name="capacity">Начальная ёмкость (округляется вверх до степени двойки).</param>
+    /// <param name="maxLoad">Максимальный коэффициент загрузки.</param>
+    IntSet(size_t capacity = 16, double maxLoad = 0.7) : table(capacity, maxLoad) {}
+
+    /// <summary>
+    /// Вставка элемента в множество с проверкой на дубликат (один проход пробирования).
+    /// </summary>
+    /// <returns>Пара (итератор на элемент в множестве, true если элемент был вставлен).</returns>
+    std::pair<Iterator, bool> insert(const Value& value) {
+        return table.insertUnique(value);
+    }
+
+    bool contains(const Value& value) const {
+        return table.contains(value);
+    }
+
+    /// <summary>
+    /// Удаление элемента из множества.
+    /// Если элемент не найден, будет сгенерировано исключение runtime_error (как в Set).
+    /// </summary>
+    void remove(const Value& value) {
+        table.remove(value);
+    }
+
+    void clear() {
+        table.clear();
+    }
+
+    size_t size() const {
+        return table.size();
+    }
+
+    void reserve(size_t n) {
+        table.reserve(n);
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (auto it = table.begin(); it != table.end(); ++it) {
+            visit(*it);
+        }
+    }
+
+    /// <summary>
+    /// Объединение: копируется большее множество, в него досыпаются элементы меньшего.
+    /// </summary>
+    IntSet operator|(const IntSet& other) const {
+        const IntSet& larger = size() >= other.size() ? *this : other;
+        const IntSet& smaller = size() >= other.size() ? other : *this;
+        IntSet result(larger);
+        smaller.forEach([&result](const Value& value) {
+            result.table.insert(value);
+        });
+        return result;
+    }
+
+    /// <summary>
+    /// Пересечение: обходится меньшее множество, проверка идёт в большем.
+    /// </summary>
+    IntSet operator&(const IntSet& other) const {
+        const IntSet& larger = size() >= other.size() ? *this : other;
+        const IntSet& smaller = size() >= other.size() ? other : *this;
+        return select(smaller, [&larger](const Value& value) {
+            return larger.contains(value);
+        });
+    }
+
+    IntSet operator-(const IntSet& other) const {
+        return select(*this, [&other](const Value& value) {
+            return !other.contains(value);
+        });
+    }
+
+    IntSet operator^(const IntSet& other) const {
+        IntSet result = *this - other;
+        other.forEach([this, &result](const Value& value) {
+            if (!contains(value)) {
+                result.table.insert(value);
+            }
+        });
+        return result;
+    }
+
+    bool isSubsetOf(const IntSet& other) const {
+        if (size() > other.size()) {
+            return false;
+        }
+        bool holds = true;
+        forEach([&other, &holds](const Value& value) {
+            holds = holds && other.contains(value);
+        });
+        return holds;
+    }
+
+    bool isDisjoint(const IntSet& other) const {
+        const IntSet& larger = size() >= other.size() ? *this : other;
+        const IntSet& smaller = size() >= other.size() ? other : *this;
+        bool disjoint = true;
+        smaller.forEach([&larger, &disjoint](const Value& value) {
+            disjoint = disjoint && !larger.contains(value);
+        });
+        return disjoint;
+    }
+
+    Iterator begin() const {
+        return table.begin();
+    }
+
+    Iterator end() const {
+        return table.end();
+    }
+
+    /// <summary>
+    /// Функция для тестирования IntSet
+    /// </summary>
+    static void testIntSet() {
+        IntSet<int> ids;
+        auto first = ids.insert(7);
+        assert(first.second && *first.first == 7);
+        auto again = ids.insert(7);
+        assert(!again.second && *again.first == 7 && again.first != ids.end());
+        ids.insert(-3);
+        ids.insert(std::numeric_limits<int>::max()); // Ключ-страж таблицы
+        assert(ids.size() == 3 && ids.contains(-3) && ids.contains(std::numeric_limits<int>::max()));
+        ids.remove(-3);
+        assert(!ids.contains(-3));
+        try {
+            ids.remove(-3);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        IntSet<uint32_t> a;
+        IntSet<uint32_t> b;
+        for (uint32_t i = 0; i < 1000; i += 2) {
+            a.insert(i);
+        }
+        for (uint32_t i = 0; i < 1500; i += 3) {
+            b.insert(i);
+        }
+        size_t common = (1000 + 5) / 6;
+        assert((a & b).size() == common);
+        assert((a | b).size() == a.size() + b.size() - common);
+        assert((a - b).size() == a.size() - common);
+        assert((a ^ b).size() == a.size() + b.size() - 2 * common);
+        assert((a & b).isSubsetOf(a) && !a.isSubsetOf(b));
+        assert((a - b).isDisjoint(b) && !a.isDisjoint(b));
+
+        size_t visited = 0;
+        for (auto it = a.begin(); it != a.end(); ++it) {
+            assert(*it % 2 == 0);
+            visited++;
+        }
+        assert(visited == a.size());
+
+        std::cout << "All INT SET tests passed!" << std::endl;
+    }
+};
@@ -0,0 +1,327 @@
+﻿#pragma once
+#include <list>
+#include <iterator>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+
+/// <summary>
+/// Политика вытеснения LRUCache.
+/// </summary>
+enum class CachePolicy {
+    LRU,   // Точный LRU: при попадании узел переносится в начало списка
+    Clock  // Приближение CLOCK: при попадании ставится бит обращения, список не перестраивается
+};
+
+/// <summary>
+/// Кеш ограниченного размера с вытеснением за O(1).
+/// Записи лежат в std::list (узлы не перемещаются), а поиск идёт через HashTable
+/// итераторов этого списка - та же хеш-таблица, что и у Dictionary, с поиском по хешу ключа
+/// (findByHash). Ёмкость задаётся суммарным весом записей: по умолчанию вес записи 1
+/// (ограничение по количеству), либо вес считает функция weigher (например, размер в байтах).
+/// LRU при каждом попадании переносит узел в начало списка (splice, без выделения памяти);
+/// CLOCK при попадании только ставит бит обращения, а при вытеснении стрелка обходит список
+/// по кругу, сбрасывая биты, и вытесняет первую запись без бита.
+/// </summary>
+/// <typeparam name="Key">Тип ключа</typeparam>
+/// <typeparam name="Value">Тип значения</typeparam>
+template <typename Key, typename Value>
+class LRUCache {
+private:
+    struct Node {
+        Key key;
+        Value value;
+        size_t weight; // Вес записи
+        bool referenced; // Бит обращения (CLOCK)
+    };
+
+    using NodeIterator = typename std::list<Node>::iterator;
+
+    std::list<Node> nodes; // LRU: от недавних к давним; CLOCK: круговой порядок обхода стрелки
+    HashTable<NodeIterator> lookup; // Поиск узла по ключу
+    std::function<size_t(const Key&, const Value&)> weigher; // Вес записи (пусто - 1)
+    CachePolicy policy;
+    size_t maxWeight; // Ёмкость кеша
+    size_t totalWeight; // Текущий суммарный вес
+    NodeIterator hand; // Стрелка CLOCK (nodes.end(), если список пуст)
+    size_t hitCount;
+    size_t missCount;
+    size_t evictionCount;
+
+    static size_t nodeHash(const NodeIterator& node) {
+        return fnv1aHash<Key>(node->key);
+    }
+
+    NodeIterator* findNode(const Key& key, size_t hash) {
+        return lookup.findByHash(hash, [&key](const NodeIterator& node) {
+            return node->key == key;
+        });
+    }
+
+    size_t weigh(const Key& key, const Value& value) const {
+        return weigher ? weigher(key, value) : 1;
+    }
+
+    /// <summary>
+    /// Отмечает обращение к узлу в соответствии с политикой.
+    /// </summary>
+    void touch(NodeIterator node) {
+        if (policy == CachePolicy::LRU) {
+            nodes.splice(nodes.begin(), nodes, node);
+        }
+        else {
+            node->referenced = true;
+        }
+    }
+
+    void erase(NodeIterator node) {
+        if (node == hand) {
+            ++hand;
+            if (hand == nodes.end()) {
+                hand = nodes.begin();
+            }
+            if (hand == node) {
+                hand = nodes.end();
+            }
+        }
+        const Key& key = node->key;
+        lookup.removeByHash(fnv1aHash<Key>(key), [&node](const NodeIterator& candidate) {
+            return candidate == node;
+        });
+        totalWeight -= node->weight;
+        nodes.erase(node);
+    }
+
+    /// <summary>
+    /// Выбирает жертву вытеснения.
+    /// BigO: LRU - O(1); CLOCK - O(1) амортизированно (каждый бит сбрасывается не чаще, чем ставится)
+    /// </summary>
+    NodeIterator victim() {
+        if (policy == CachePolicy::LRU) {
+            return std::prev(nodes.end());
+        }
+        if (hand == nodes.end()) {
+            hand = nodes.begin();
+        }
+        while (hand->referenced) {
+            hand->referenced = false;
+            ++hand;
+            if (hand == nodes.end()) {
+                hand = nodes.begin();
+            }
+        }
+        return hand;
+    }
+
+    void evictToCapacity() {
+        while (totalWeight > maxWeight && !nodes.empty()) {
+            erase(victim());
+            evictionCount++;
+        }
+    }
+
+public:
+    /// <summary>
+    /// Конструктор кеша.
+    /// </summary>
+    /// <param name="capacity">Ёмкость: максимальный суммарный вес записей.</param>
+    /// <param name="policy">Политика вытеснения.</param>
+    /// <param name="weigher">Функция веса записи (key, value) -> size_t; по умолчанию вес каждой записи 1.</param>
+    LRUCache(size_t capacity, CachePolicy policy = CachePolicy::LRU,
+        std::function<size_t(const Key&, const Value&)> weigher = nullptr)
+        : lookup(nodeHash), weigher(weigher), policy(policy), maxWeight(capacity), totalWeight(0),
+        hand(nodes.end()), hitCount(0), missCount(0), evictionCount(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Cache capacity must be positive");
+        }
+    }
+
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+
+    /// <summary>
+    /// Поиск значения с учётом обращения (счётчики попаданий и промахов).
+    /// </summary>
+    /// <returns>Указатель на значение в кеше или nullptr. Действителен до следующего put.</returns>
+    /// <BigO>Среднее : O(1)</BigO>
+    Value* get(const Key& key) {
+        NodeIterator* node = findNode(key, fnv1aHash<Key>(key));
+        if (node == nullptr) {
+            missCount++;
+            return nullptr;
+        }
+        hitCount++;
+        NodeIterator target = *node;
+        touch(target);
+        return &target->value;
+    }
+
+    /// <summary>
+    /// Вставка или обновление записи; затем вытесняются записи, пока вес превышает ёмкость.
+    /// Запись тяжелее всей ёмкости вытесняется сразу же.
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    void put(const Key& key, const Value& value) {
+        size_t hash = fnv1aHash<Key>(key);
+        size_t weight = weigh(key, value);
+        NodeIterator* existing = findNode(key, hash);
+        if (existing != nullptr) {
+            NodeIterator node = *existing;
+            totalWeight = totalWeight - node->weight + weight;
+            node->value = value;
+            node->weight = weight;
+            touch(node);
+        }
+        else {
+            NodeIterator node;
+            if (policy == CachePolicy::LRU) {
+                node = nodes.insert(nodes.begin(), Node{ key, value, weight, false });
+            }
+            else {
+                // Новая запись встаёт перед стрелкой - стрелка дойдёт до неё последней
+                node = nodes.insert(hand, Node{ key, value, weight, false });
+            }
+            lookup.insertByHash(hash, NodeIterator(node));
+            totalWeight += weight;
+        }
+        evictToCapacity();
+    }
+
+    /// <summary>
+    /// Мемоизация: возвращает значение из кеша или вычисляет compute(key), кладёт в кеш и возвращает.
+    /// </summary>
+    template <typename Compute>
+    Value getOrCompute(const Key& key, Compute compute) {
+        Value* cached = get(key);
+        if (cached != nullptr) {
+            return *cached;
+        }
+        Value value = compute(key);
+        put(key, value);
+        return value;
+    }
+
+    /// <summary>
+    /// Проверка наличия ключа без учёта обращения.
+    /// </summary>
+    bool contains(const Key& key) {
+        return findNode(key, fnv1aHash<Key>(key)) != nullptr;
+    }
+
+    /// <summary>
+    /// Удаление записи по ключу.
+    /// </summary>
+    /// <returns>true, если запись была в кеше.</returns>
+    bool remove(const Key& key) {
+        NodeIterator* node = findNode(key, fnv1aHash<Key>(key));
+        if (node == nullptr) {
+            return false;
+        }
+        erase(*node);
+        return true;
+    }
+
+    void clear() {
+        nodes.clear();
+        lookup.clear();
+        totalWeight = 0;
+        hand = nodes.end();
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    size_t weight() const {
+        return totalWeight;
+    }
+
+    size_t capacity() const {
+        return maxWeight;
+    }
+
+    size_t hits() const {
+        return hitCount;
+    }
+
+    size_t misses() const {
+        return missCount;
+    }
+
+    size_t evictions() const {
+        return evictionCount;
+    }
+
+    /// <summary>
+    /// Функция для тестирования LRUCache
+    /// </summary>
+    static void testLRUCache() {
+        // LRU по количеству записей
+        LRUCache<int, std::string> lru(3);
+        lru.put(1, "one");
+        lru.put(2, "two");
+        lru.put(3, "three");
+        assert(lru.get(1) != nullptr && *lru.get(1) == "one"); // 1 становится самой свежей
+        lru.put(4, "four"); // Вытесняется 2
+        assert(lru.size() == 3);
+        assert(!lru.contains(2));
+        assert(lru.contains(1) && lru.contains(3) && lru.contains(4));
+        assert(lru.evictions() == 1);
+        assert(lru.get(2) == nullptr);
+        assert(lru.hits() == 2 && lru.misses() == 1);
+
+        lru.put(3, "THREE"); // Обновление без вытеснения
+        assert(*lru.get(3) == "THREE");
+        assert(lru.remove(3));
+        assert(!lru.remove(3));
+        assert(lru.size() == 2);
+
+        // Вес в байтах
+        LRUCache<std::string, std::string> bytes(10, CachePolicy::LRU,
+            [](const std::string& key, const std::string& value) { return key.size() + value.size(); });
+        bytes.put("a", "1234"); // 5
+        bytes.put("b", "1234"); // 5
+        assert(bytes.weight() == 10 && bytes.size() == 2);
+        bytes.put("c", "12"); // 3: вытесняется "a"
+        assert(!bytes.contains("a") && bytes.weight() == 8);
+        bytes.put("huge", "0123456789"); // Тяжелее ёмкости: вытесняется всё, включая её саму
+        assert(bytes.size() == 0 && bytes.weight() == 0);
+
+        // CLOCK: запись с битом обращения переживает проход стрелки
+        LRUCache<int, int> clock(3, CachePolicy::Clock);
+        clock.put(1, 10);
+        clock.put(2, 20);
+        clock.put(3, 30);
+        assert(clock.get(1) != nullptr);
+        clock.put(4, 40); // Стрелка: 1 (бит сброшен) -> 2 вытесняется
+        assert(clock.contains(1) && !clock.contains(2) && clock.contains(3) && clock.contains(4));
+        clock.put(5, 50); // 3 без бита
+        assert(!clock.contains(3) && clock.contains(1));
+        assert(clock.evictions() == 2);
+
+        // Мемоизация с ограниченной памятью
+        LRUCache<int, long long> memo(100, CachePolicy::Clock);
+        int computed = 0;
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < 50; ++i) {
+                long long square = memo.getOrCompute(i, [&computed](int x) {
+                    computed++;
+                    return static_cast<long long>(x) * x;
+                });
+                assert(square == static_cast<long long>(i) * i);
+            }
+        }
+        assert(computed == 50);
+        for (int i = 0; i < 10000; ++i) {
+            memo.put(i, i);
+        }
+        assert(memo.size() == 100);
+        assert(memo.evictions() == 10000 - 100);
+
+        std::cout << "All LRU CACHE tests passed!" << std::endl;
+    }
+};
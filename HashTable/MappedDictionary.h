@@ -0,0 +1,461 @@
+﻿#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include <cassert>
+#include <iostream>
+#include "HashTable.h"
+#include "Dictionary.h"
+#include "MappedFile.h"
+
+/// <summary>
+/// Описание того, как тип ключа или значения хранится в двоичном файле словаря.
+/// Тривиально копируемые типы лежат прямо в записи (выравнивание до 8 байт).
+/// Код типа - размер, знаковость и признаки вещественного и составного типа, чтобы файл
+/// с int не открывался как unsigned или float того же размера.
+/// </summary>
+template <typename T>
+struct BinaryField {
+    static_assert(std::is_trivially_copyable<T>::value, "BinaryField requires a trivially copyable type or std::basic_string");
+
+    using View = T; // Тип, которым значение возвращается из отображённого файла
+    static const uint32_t kind = static_cast<uint32_t>(sizeof(T)) // Код типа в заголовке
+        | (std::is_signed<T>::value ? 0x100u : 0u)
+        | (std::is_floating_point<T>::value ? 0x200u : 0u)
+        | (std::is_arithmetic<T>::value || std::is_enum<T>::value ? 0u : 0x400u);
+    static const size_t recordSize = (sizeof(T) + 7) / 8 * 8; // Байт в записи
+
+    static uint64_t hash(const View& value) {
+        return stableBytesHash(&value, sizeof(T));
+    }
+
+    static uint64_t blobBytes(const T&) {
+        return 0;
+    }
+
+    static void writeRecord(char* record, const T& value, uint64_t&) {
+        std::memcpy(record, &value, sizeof(T));
+    }
+
+    static void writeBlob(std::ostream&, const T&) {}
+
+    static View read(const char* record, const char*, uint64_t) {
+        T value;
+        std::memcpy(&value, record, sizeof(T));
+        return value;
+    }
+};
+
+/// <summary>
+/// Строки хранятся в общей области blob, а в записи - смещение и длина (в символах).
+/// </summary>
+template <typename CharT, typename Traits, typename Allocator>
+struct BinaryField<std::basic_string<CharT, Traits, Allocator>> {
+    using View = std::basic_string_view<CharT, Traits>;
+    static const uint32_t kind = 0x10000 | sizeof(CharT);
+    static const size_t recordSize = 2 * sizeof(uint64_t);
+
+    static uint64_t hash(const View& value) {
+        return stableBytesHash(value.data(), value.size() * sizeof(CharT));
+    }
+
+    static uint64_t blobBytes(const std::basic_string<CharT, Traits, Allocator>& value) {
+        return value.size() * sizeof(CharT);
+    }
+
+    static void writeRecord(char* record, const std::basic_string<CharT, Traits, Allocator>& value, uint64_t& blobOffset) {
+        uint64_t location[2] = { blobOffset, value.size() };
+        std::memcpy(record, location, sizeof(location));
+        blobOffset += blobBytes(value);
+    }
+
+    static void writeBlob(std::ostream& out, const std::basic_string<CharT, Traits, Allocator>& value) {
+        out.write(reinterpret_cast<const char*>(value.data()), static_cast<std::streamsize>(blobBytes(value)));
+    }
+
+    static View read(const char* record, const char* blob, uint64_t blobSize) {
+        uint64_t location[2];
+        std::memcpy(location, record, sizeof(location));
+        if (location[0] > blobSize || location[1] > (blobSize - location[0]) / sizeof(CharT)) {
+            throw std::runtime_error("Corrupted dictionary file");
+        }
+        return View(reinterpret_cast<const CharT*>(blob + location[0]), static_cast<size_t>(location[1]));
+    }
+};
+
+/// <summary>
+/// Словарь только для чтения поверх отображённого в память двоичного файла.
+/// Файл записывается из Dictionary методом save/write, а открывается без разбора и без
+/// выделения памяти под пары: поиск идёт прямо по отображённым страницам, поэтому запуск
+/// со словарём в несколько гигабайт занимает миллисекунды, а читаются только нужные страницы.
+/// Формат (порядок байтов платформы):
+///   заголовок: метка "DIC1", версия, коды типов ключа и значения, количество пар,
+///              количество ячеек индекса, размер записи, размер области строк;
+///   индекс:    ячейки uint32 (0 - пусто, иначе номер записи + 1), открытая адресация,
+///              линейное пробирование, загрузка не больше 1/2;
+///   записи:    [хеш ключа uint64][поле ключа][поле значения] фиксированного размера;
+///   строки:    символы строковых ключей и значений подряд.
+/// Хеш - stableBytesHash, не зависящий от сборки.
+/// </summary>
+/// <typeparam name="Key">Тип ключа: тривиально копируемый или std::basic_string</typeparam>
+/// <typeparam name="Value">Тип значения: тривиально копируемый или std::basic_string</typeparam>
+template <typename Key, typename Value>
+class MappedDictionary {
+private:
+    using KeyField = BinaryField<Key>;
+    using ValueField = BinaryField<Value>;
+    using KeyView = typename KeyField::View;
+    using ValueView = typename ValueField::View;
+
+    static const uint32_t magic = 0x31434944; // "DIC1"
+    static const uint32_t version = 2; // 2: коды типов учитывают знаковость и вещественность
+    static const size_t recordSize = sizeof(uint64_t) + KeyField::recordSize + ValueField::recordSize;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t keyKind;
+        uint32_t valueKind;
+        uint64_t count;
+        uint64_t slotCount;
+        uint64_t recordSize;
+        uint64_t blobSize;
+    };
+
+    MappedFile file; // Отображение файла
+    FileHeader header; // Копия заголовка
+    const char* slots; // Начало индекса
+    const char* records; // Начало записей
+    const char* blob; // Начало области строк
+
+    static size_t slotFor(uint64_t hash, uint64_t slotCount) {
+        return static_cast<size_t>(mix64(hash) & (slotCount - 1));
+    }
+
+    uint32_t readSlot(size_t slot) const {
+        uint32_t value;
+        std::memcpy(&value, slots + slot * sizeof(uint32_t), sizeof(value));
+        return value;
+    }
+
+    KeyView keyAt(const char* record) const {
+        return KeyField::read(record + sizeof(uint64_t), blob, header.blobSize);
+    }
+
+    ValueView valueAt(const char* record) const {
+        return ValueField::read(record + sizeof(uint64_t) + KeyField::recordSize, blob, header.blobSize);
+    }
+
+    /// <summary>
+    /// Ищет запись по ключу. Просматривается не больше slotCount ячеек: если пустая ячейка
+    /// не встретилась, индекс повреждён и будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <returns>Указатель на запись в отображении или nullptr.</returns>
+    const char* findRecord(const KeyView& key) const {
+        if (header.count == 0) {
+            return nullptr;
+        }
+        uint64_t hash = KeyField::hash(key);
+        size_t slot = slotFor(hash, header.slotCount);
+        for (uint64_t probe = 0; probe < header.slotCount; ++probe, slot = (slot + 1) & (header.slotCount - 1)) {
+            uint32_t value = readSlot(slot);
+            if (value == 0) {
+                return nullptr;
+            }
+            if (value > header.count) {
+                throw std::runtime_error("Corrupted dictionary file");
+            }
+            const char* record = records + (value - 1) * recordSize;
+            uint64_t recordHash;
+            std::memcpy(&recordHash, record, sizeof(recordHash));
+            if (recordHash == hash && keyAt(record) == key) {
+                return record;
+            }
+        }
+        throw std::runtime_error("Corrupted dictionary file");
+    }
+
+public:
+    /// <summary>
+    /// Открывает файл, записанный save/write, и проверяет заголовок и размеры разделов.
+    /// Если формат или типы не совпадают, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <param name="path">Путь к файлу словаря.</param>
+    explicit MappedDictionary(const std::string& path) : file(path) {
+        if (file.size() < sizeof(FileHeader)) {
+            throw std::runtime_error("Invalid dictionary file");
+        }
+        std::memcpy(&header, file.data(), sizeof(FileHeader));
+        if (header.magic != magic || header.version != version) {
+            throw std::runtime_error("Invalid dictionary file");
+        }
+        if (header.keyKind != KeyField::kind || header.valueKind != ValueField::kind || header.recordSize != recordSize) {
+            throw std::runtime_error("Dictionary file has different key or value types");
+        }
+        // Размеры разделов проверяются делением по очереди, чтобы произведения не переполнялись
+        bool validSlots = header.slotCount >= 2 && (header.slotCount & (header.slotCount - 1)) == 0
+            && header.count < header.slotCount;
+        uint64_t remaining = file.size() - sizeof(FileHeader);
+        if (!validSlots || header.slotCount > remaining / sizeof(uint32_t)) {
+            throw std::runtime_error("Corrupted dictionary file");
+        }
+        uint64_t slotBytes = header.slotCount * sizeof(uint32_t);
+        remaining -= slotBytes;
+        if (header.count > remaining / recordSize) {
+            throw std::runtime_error("Corrupted dictionary file");
+        }
+        remaining -= header.count * recordSize;
+        if (header.blobSize != remaining) {
+            throw std::runtime_error("Corrupted dictionary file");
+        }
+
+        slots = file.data() + sizeof(FileHeader);
+        records = slots + slotBytes;
+        blob = records + header.count * recordSize;
+    }
+
+    /// <summary>
+    /// Поиск значения по ключу прямо в отображённом файле.
+    /// Строковые значения возвращаются как string_view на память отображения
+    /// (действительны, пока жив MappedDictionary).
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    std::optional<ValueView> find(const KeyView& key) const {
+        const char* record = findRecord(key);
+        if (record == nullptr) {
+            return std::nullopt;
+        }
+        return valueAt(record);
+    }
+
+    /// <summary>
+    /// Получение значения по ключу.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    ValueView get(const KeyView& key) const {
+        const char* record = findRecord(key);
+        if (record == nullptr) {
+            throw std::runtime_error("Key not found");
+        }
+        return valueAt(record);
+    }
+
+    bool contains(const KeyView& key) const {
+        return findRecord(key) != nullptr;
+    }
+
+    size_t size() const {
+        return static_cast<size_t>(header.count);
+    }
+
+    /// <summary>
+    /// Обходит пары (ключ, значение) в порядке записей файла.
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (uint64_t i = 0; i < header.count; ++i) {
+            const char* record = records + i * recordSize;
+            visit(keyAt(record), valueAt(record));
+        }
+    }
+
+    /// <summary>
+    /// Записывает словарь в поток в двоичном формате MappedDictionary.
+    /// Пары не копируются: словарь обходится три раза (хеши, записи, строки),
+    /// и в памяти держится только индекс - 8 байт на пару при построении.
+    /// Если запись не удалась, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <BigO>O(n)</BigO>
+    static void write(const Dictionary<Key, Value>& dictionary, std::ostream& out) {
+        FileHeader fileHeader = { magic, version, KeyField::kind, ValueField::kind, dictionary.size(), 2, recordSize, 0 };
+        if (fileHeader.count >= 0xFFFFFFFFULL) {
+            throw std::runtime_error("Dictionary is too large for the binary format");
+        }
+        while (fileHeader.slotCount < 2 * fileHeader.count) {
+            fileHeader.slotCount <<= 1;
+        }
+
+        // Проход 1: хеши ключей -> индекс, размер области строк
+        std::vector<uint32_t> index(static_cast<size_t>(fileHeader.slotCount), 0);
+        uint32_t number = 0;
+        dictionary.forEach([&](const std::pair<Key, Value>& pair) {
+            size_t slot = slotFor(KeyField::hash(pair.first), fileHeader.slotCount);
+            while (index[slot] != 0) {
+                slot = (slot + 1) & (index.size() - 1);
+            }
+            index[slot] = ++number;
+            fileHeader.blobSize += KeyField::blobBytes(pair.first) + ValueField::blobBytes(pair.second);
+        });
+        out.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+        out.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(uint32_t)));
+
+        // Проход 2: записи фиксированного размера
+        char record[recordSize];
+        uint64_t blobOffset = 0;
+        dictionary.forEach([&](const std::pair<Key, Value>& pair) {
+            std::memset(record, 0, recordSize);
+            uint64_t hash = KeyField::hash(pair.first);
+            std::memcpy(record, &hash, sizeof(hash));
+            KeyField::writeRecord(record + sizeof(uint64_t), pair.first, blobOffset);
+            ValueField::writeRecord(record + sizeof(uint64_t) + KeyField::recordSize, pair.second, blobOffset);
+            out.write(record, recordSize);
+        });
+
+        // Проход 3: символы строк в том же порядке
+        dictionary.forEach([&](const std::pair<Key, Value>& pair) {
+            KeyField::writeBlob(out, pair.first);
+            ValueField::writeBlob(out, pair.second);
+        });
+        if (!out) {
+            throw std::runtime_error("Cannot write dictionary");
+        }
+    }
+
+    /// <summary>
+    /// Записывает словарь в файл (см. write).
+    /// </summary>
+    static void save(const Dictionary<Key, Value>& dictionary, const std::string& path) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        write(dictionary, out);
+    }
+
+    /// <summary>
+    /// Функция для тестирования MappedDictionary
+    /// </summary>
+    static void testMappedDictionary() {
+        std::string path = (std::filesystem::temp_directory_path() / "mapped_dictionary_test.bin").string();
+
+        // Строка -> число
+        Dictionary<std::string, int> counters;
+        for (int i = 0; i < 5000; ++i) {
+            counters.put("word" + std::to_string(i), i);
+        }
+        counters.put("", -1);
+        MappedDictionary<std::string, int>::save(counters, path);
+        {
+            MappedDictionary<std::string, int> mapped(path);
+            assert(mapped.size() == counters.size());
+            for (int i = 0; i < 5000; ++i) {
+                assert(mapped.get("word" + std::to_string(i)) == i);
+            }
+            assert(mapped.get("") == -1);
+            assert(!mapped.find("missing").has_value());
+            try {
+                mapped.get("missing");
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            size_t visited = 0;
+            mapped.forEach([&](std::string_view key, int value) {
+                assert(counters.get(std::string(key)) == value);
+                visited++;
+            });
+            assert(visited == counters.size());
+        }
+
+        // Типы не совпадают с записанными
+        try {
+            MappedDictionary<int, int> wrongTypes(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        // Число -> строка
+        Dictionary<int, std::string> labels;
+        labels.put(1, "one");
+        labels.put(2, "two");
+        labels.put(42, "answer");
+        MappedDictionary<int, std::string>::save(labels, path);
+        {
+            MappedDictionary<int, std::string> mapped(path);
+            assert(mapped.get(42) == "answer");
+            assert(*mapped.find(1) == "one");
+            assert(!mapped.contains(3));
+        }
+
+        // Тот же размер, но другая знаковость или вещественность
+        Dictionary<int, int> signedValues;
+        signedValues.put(7, -7);
+        MappedDictionary<int, int>::save(signedValues, path);
+        try {
+            MappedDictionary<int, unsigned> wrongSign(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        try {
+            MappedDictionary<int, float> wrongFloat(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        // Индекс без пустых ячеек: поиск отсутствующего ключа не зацикливается
+        {
+            std::fstream patch(path, std::ios::binary | std::ios::in | std::ios::out);
+            uint32_t full[2] = { 1, 1 }; // slotCount = 2 при одной паре
+            patch.seekp(sizeof(FileHeader));
+            patch.write(reinterpret_cast<const char*>(full), sizeof(full));
+        }
+        {
+            MappedDictionary<int, int> mapped(path);
+            assert(mapped.get(7) == -7);
+            try {
+                mapped.contains(8);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+        }
+
+        // Заголовок с огромными размерами разделов: произведения переполнились бы до 0
+        {
+            FileHeader huge = { magic, version, BinaryField<int>::kind, BinaryField<int>::kind,
+                uint64_t(1) << 61, uint64_t(1) << 62, MappedDictionary<int, int>::recordSize, 0 };
+            std::ofstream crafted(path, std::ios::binary | std::ios::trunc);
+            crafted.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+        }
+        try {
+            MappedDictionary<int, int> mapped(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        // Пустой словарь
+        Dictionary<int, double> empty;
+        MappedDictionary<int, double>::save(empty, path);
+        {
+            MappedDictionary<int, double> mapped(path);
+            assert(mapped.size() == 0 && !mapped.contains(0));
+        }
+
+        // Обрезанный файл
+        {
+            std::ofstream broken(path, std::ios::binary | std::ios::trunc);
+            broken << "DIC1";
+        }
+        try {
+            MappedDictionary<int, double> mapped(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        std::filesystem::remove(path);
+        std::cout << "All MAPPED DIC tests passed!" << std::endl;
+    }
+};
@@ -0,0 +1,150 @@
+﻿#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN // Без rpcndr.h, где byte конфликтует с std::byte
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// Файл, отображённый в память только для чтения (mmap в POSIX, CreateFileMapping в Windows).
+/// Содержимое не копируется: страницы подгружаются операционной системой по мере обращения,
+/// поэтому "открытие" даже очень большого файла занимает миллисекунды.
+/// Отображение освобождается в деструкторе; объект можно перемещать, но не копировать.
+/// </summary>
+class MappedFile {
+private:
+    const char* bytes; // Начало отображения (nullptr для пустого файла)
+    size_t length; // Размер файла в байтах
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    void release() {
+#ifdef _WIN32
+        if (bytes != nullptr) {
+            UnmapViewOfFile(bytes);
+        }
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes != nullptr) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+public:
+    /// <summary>
+    /// Отображает файл в память.
+    /// Если файл не удаётся открыть или отобразить, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <param name="path">Путь к файлу.</param>
+    explicit MappedFile(const std::string& path) : bytes(nullptr), length(0) {
+#ifdef _WIN32
+        mapping = NULL;
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            release();
+            throw std::runtime_error("Cannot get file size: " + path);
+        }
+        if (fileSize.QuadPart == 0) {
+            return;
+        }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void* view = mapping == NULL ? NULL : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL) {
+            release();
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        bytes = static_cast<const char*>(view);
+        length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        struct stat info;
+        if (fstat(descriptor, &info) != 0) {
+            close(descriptor);
+            throw std::runtime_error("Cannot get file size: " + path);
+        }
+        if (info.st_size == 0) {
+            close(descriptor);
+            return;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        close(descriptor); // Отображение остаётся действительным после закрытия дескриптора
+        if (view == MAP_FAILED) {
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        bytes = static_cast<const char*>(view);
+        length = static_cast<size_t>(info.st_size);
+#endif
+    }
+
+    MappedFile(MappedFile&& other) noexcept : bytes(other.bytes), length(other.length) {
+#ifdef _WIN32
+        file = other.file;
+        mapping = other.mapping;
+        other.file = INVALID_HANDLE_VALUE;
+        other.mapping = NULL;
+#endif
+        other.bytes = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::swap(bytes, other.bytes);
+            std::swap(length, other.length);
+#ifdef _WIN32
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+#endif
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        release();
+    }
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
@@ -0,0 +1,279 @@
+﻿#pragma once
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+#include "Set.h"
+
+/// <summary>
+/// Генератор MinHash-сигнатур множеств для оценки меры Жаккара |A ∩ B| / |A ∪ B|
+/// без пересечения самих множеств. Сигнатура - k минимумов k разных хеш-функций
+/// по элементам множества; доля совпавших позиций двух сигнатур - несмещённая оценка
+/// меры Жаккара со стандартной ошибкой около 1 / sqrt(k).
+/// Хеш элемента (keyHash64 из HashTable.h) считается один раз, а k хешей
+/// получаются из него умножением со сложением и сдвигом с разными константами - это один
+/// цикл по массивам констант и минимумов, который компилятор векторизует.
+/// </summary>
+/// <typeparam name="Value">Тип элемента множества</typeparam>
+template <typename Value>
+class MinHash {
+private:
+    std::vector<uint64_t> multipliers; // Нечётные множители хеш-функций
+    std::vector<uint64_t> offsets; // Слагаемые хеш-функций
+
+    /// <summary>
+    /// Учитывает один элемент: обновляет k минимумов.
+    /// </summary>
+    void update(uint64_t* __restrict minimums, uint64_t base) const {
+        const uint64_t* __restrict a = multipliers.data();
+        const uint64_t* __restrict b = offsets.data();
+        size_t k = multipliers.size();
+        for (size_t i = 0; i < k; ++i) {
+            uint64_t h = a[i] * base + b[i];
+            h ^= h >> 32;
+            minimums[i] = std::min(minimums[i], h);
+        }
+    }
+
+public:
+    /// <summary>
+    /// Конструктор генератора сигнатур.
+    /// Сигнатуры сравнимы только между собой при одинаковых k и seed.
+    /// </summary>
+    /// <param name="k">Длина сигнатуры (число хеш-функций).</param>
+    /// <param name="seed">Начальное значение для констант хеш-функций.</param>
+    MinHash(size_t k = 128, uint64_t seed = 0x5eed) {
+        if (k == 0) {
+            throw std::invalid_argument("MinHash signature length must be positive");
+        }
+        multipliers.resize(k);
+        offsets.resize(k);
+        uint64_t state = seed;
+        for (size_t i = 0; i < k; ++i) {
+            multipliers[i] = mix64(++state) | 1;
+            offsets[i] = mix64(++state);
+        }
+    }
+
+    size_t get_k() const {
+        return multipliers.size();
+    }
+
+    /// <summary>
+    /// Строит сигнатуру множества за один проход по элементам.
+    /// Подходит любое множество с методом forEach (Set, FlatSet, RoaringSet).
+    /// </summary>
+    /// <param name="set">Множество.</param>
+    /// <returns>Сигнатура длины k (для пустого множества - все значения максимальны).</returns>
+    /// <BigO>O(n * k)</BigO>
+    template <typename SetType>
+    std::vector<uint64_t> signature(const SetType& set) const {
+        std::vector<uint64_t> minimums(multipliers.size(), std::numeric_limits<uint64_t>::max());
+        set.forEach([&](const Value& value) {
+            update(minimums.data(), keyHash64<Value>(value));
+        });
+        return minimums;
+    }
+
+    /// <summary>
+    /// Оценка меры Жаккара по двум сигнатурам - доля совпавших позиций.
+    /// </summary>
+    /// <BigO>O(k)</BigO>
+    static double jaccard(const std::vector<uint64_t>& first, const std::vector<uint64_t>& second) {
+        if (first.size() != second.size() || first.empty()) {
+            throw std::invalid_argument("MinHash signatures have different lengths");
+        }
+        size_t equal = 0;
+        for (size_t i = 0; i < first.size(); ++i) {
+            equal += (first[i] == second[i]);
+        }
+        return static_cast<double>(equal) / first.size();
+    }
+
+    /// <summary>
+    /// Функция для тестирования MinHash
+    /// </summary>
+    static void testMinHash() {
+        MinHash<int> minHash(256);
+
+        Set<int> a;
+        Set<int> b;
+        Set<int> far;
+        for (int i = 0; i < 1000; ++i) {
+            a.insert(i);
+        }
+        for (int i = 500; i < 1500; ++i) {
+            b.insert(i);
+        }
+        for (int i = 100000; i < 101000; ++i) {
+            far.insert(i);
+        }
+
+        auto sigA = minHash.signature(a);
+        auto sigB = minHash.signature(b);
+        auto sigFar = minHash.signature(far);
+        assert(sigA.size() == 256);
+        assert(MinHash<int>::jaccard(sigA, minHash.signature(a)) == 1.0);
+        assert(std::abs(MinHash<int>::jaccard(sigA, sigB) - 1.0 / 3) < 0.1); // |A ∩ B| / |A ∪ B| = 500 / 1500
+        assert(MinHash<int>::jaccard(sigA, sigFar) < 0.05);
+
+        try {
+            MinHash<int>::jaccard(sigA, std::vector<uint64_t>(10));
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+
+        std::cout << "All MINHASH tests passed!" << std::endl;
+    }
+};
+
+/// <summary>
+/// Индекс LSH (locality-sensitive hashing) по MinHash-сигнатурам для поиска похожих множеств
+/// без сравнения всех пар. Сигнатура делится на b полос по r значений; множества, у которых
+/// совпала хотя бы одна полоса целиком, становятся кандидатами. Вероятность попасть в кандидаты
+/// при мере Жаккара s равна 1 - (1 - s^r)^b - резкий порог около (1 / b)^(1 / r).
+/// </summary>
+class LSHIndex {
+private:
+    size_t bands; // Количество полос
+    size_t rows; // Значений сигнатуры в полосе
+    std::vector<std::unordered_map<uint64_t, std::vector<size_t>>> tables; // По таблице на полосу: хеш полосы -> идентификаторы
+
+    uint64_t bandHash(const std::vector<uint64_t>& signature, size_t band) const {
+        uint64_t hash = band;
+        for (size_t r = 0; r < rows; ++r) {
+            hash = mix64(hash ^ signature[band * rows + r]);
+        }
+        return hash;
+    }
+
+    void checkLength(const std::vector<uint64_t>& signature) const {
+        if (signature.size() != bands * rows) {
+            throw std::invalid_argument("Signature length must equal bands * rows");
+        }
+    }
+
+public:
+    /// <summary>
+    /// Конструктор индекса.
+    /// </summary>
+    /// <param name="bands">Количество полос b.</param>
+    /// <param name="rows">Значений в полосе r (длина сигнатуры должна быть b * r).</param>
+    LSHIndex(size_t bands, size_t rows) : bands(bands), rows(rows), tables(bands) {
+        if (bands == 0 || rows == 0) {
+            throw std::invalid_argument("LSH bands and rows must be positive");
+        }
+    }
+
+    /// <summary>
+    /// Добавляет сигнатуру множества с заданным идентификатором.
+    /// </summary>
+    /// <BigO>O(k)</BigO>
+    void insert(size_t id, const std::vector<uint64_t>& signature) {
+        checkLength(signature);
+        for (size_t band = 0; band < bands; ++band) {
+            tables[band][bandHash(signature, band)].push_back(id);
+        }
+    }
+
+    /// <summary>
+    /// Кандидаты в похожие на множество с данной сигнатурой.
+    /// </summary>
+    /// <returns>Отсортированные идентификаторы без повторов.</returns>
+    /// <BigO>O(k + число кандидатов)</BigO>
+    std::vector<size_t> query(const std::vector<uint64_t>& signature) const {
+        checkLength(signature);
+        std::vector<size_t> candidates;
+        for (size_t band = 0; band < bands; ++band) {
+            auto it = tables[band].find(bandHash(signature, band));
+            if (it != tables[band].end()) {
+                candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        return candidates;
+    }
+
+    /// <summary>
+    /// Все пары кандидатов (id1 &lt; id2), совпавшие хотя бы в одной полосе.
+    /// </summary>
+    /// <returns>Отсортированные пары без повторов.</returns>
+    std::vector<std::pair<size_t, size_t>> candidatePairs() const {
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (const auto& table : tables) {
+            for (const auto& bucket : table) {
+                const auto& ids = bucket.second;
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    for (size_t j = i + 1; j < ids.size(); ++j) {
+                        pairs.emplace_back(std::min(ids[i], ids[j]), std::max(ids[i], ids[j]));
+                    }
+                }
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        return pairs;
+    }
+
+    /// <summary>
+    /// Функция для тестирования LSHIndex
+    /// </summary>
+    static void testLSHIndex() {
+        MinHash<int> minHash(256);
+
+        Set<int> a;
+        Set<int> b;
+        Set<int> far;
+        for (int i = 0; i < 1000; ++i) {
+            a.insert(i);
+        }
+        for (int i = 500; i < 1500; ++i) {
+            b.insert(i);
+        }
+        for (int i = 100000; i < 101000; ++i) {
+            far.insert(i);
+        }
+        auto sigA = minHash.signature(a);
+        auto sigB = minHash.signature(b);
+        auto sigFar = minHash.signature(far);
+
+        // Почти-дубликат: A без 50 элементов (мера Жаккара 0.95)
+        Set<int> nearA;
+        for (int i = 50; i < 1000; ++i) {
+            nearA.insert(i);
+        }
+
+        LSHIndex index(32, 8);
+        index.insert(0, sigA);
+        index.insert(1, minHash.signature(nearA));
+        index.insert(2, sigFar);
+        index.insert(3, sigB);
+
+        auto candidates = index.query(sigA);
+        assert(std::find(candidates.begin(), candidates.end(), 1) != candidates.end());
+        assert(std::find(candidates.begin(), candidates.end(), 2) == candidates.end());
+
+        auto pairs = index.candidatePairs();
+        assert(std::find(pairs.begin(), pairs.end(), std::make_pair(size_t(0), size_t(1))) != pairs.end());
+        assert(std::find(pairs.begin(), pairs.end(), std::make_pair(size_t(0), size_t(2))) == pairs.end());
+
+        try {
+            index.insert(4, std::vector<uint64_t>(10));
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+
+        std::cout << "All LSH INDEX tests passed!" << std::endl;
+    }
+};
@@ -0,0 +1,929 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+#include <cassert>
+#include <iostream>
+#include "Set.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// <summary>
+/// Количество единичных битов в 64-битном слове (инструкция popcnt, если компилятор её знает).
+/// </summary>
+inline int popcount64(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(word));
+#elif defined(_MSC_VER)
+    return static_cast<int>(__popcnt(static_cast<unsigned int>(word)) + __popcnt(static_cast<unsigned int>(word >> 32)));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+/// <summary>
+/// Номер младшего единичного бита в ненулевом 64-битном слове.
+/// </summary>
+inline int countTrailingZeros64(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanForward(&index, static_cast<unsigned long>(word))) {
+        return static_cast<int>(index);
+    }
+    _BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+    return static_cast<int>(index) + 32;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+/// <summary>
+/// Сжатое множество 32-битных чисел в стиле Roaring bitmap.
+/// Числа делятся на блоки по старшим 16 битам (по 65536 значений), и каждый блок хранится
+/// в одном из трёх контейнеров младших 16 бит:
+/// - массив: отсортированный std::vector из uint16_t, пока в блоке не больше 4096 чисел (2 байта на число);
+/// - битовая карта: 1024 слова по 64 бита (8 КБ на блок), когда чисел больше 4096;
+/// - серии: пары (начало, длина - 1) для плотных непрерывных диапазонов (после runOptimize).
+/// Мощность битовых карт считается через popcount, объединение и пересечение карт - пословные
+/// циклы OR/AND по непрерывным массивам, которые компилятор векторизует.
+/// </summary>
+/// <BigO>
+/// contains - O(log k) (k - число блоков) + O(log 4096) внутри блока.
+/// insert/remove - то же плюс сдвиг массива до 4096 элементов.
+/// Операции над множествами - O(число блоков * 1024 слова) в худшем случае.
+/// </BigO>
+class RoaringBitmap {
+private:
+    static const uint32_t arrayLimit = 4096; // Максимальный размер контейнера-массива
+    static const size_t bitmapWords = 1024; // 65536 бит / 64
+
+    enum class ContainerType { Array, Bitmap, Run };
+    enum class Operation { Or, And, AndNot, Xor };
+
+    /// <summary>
+    /// Контейнер младших 16 бит одного блока.
+    /// </summary>
+    struct Container {
+        ContainerType type = ContainerType::Array;
+        std::vector<uint16_t> array; // Отсортированные значения (тип Array)
+        std::vector<uint64_t> bitmap; // 1024 слова (тип Bitmap)
+        std::vector<std::pair<uint16_t, uint16_t>> runs; // (начало, длина - 1), отсортированы (тип Run)
+        uint32_t cardinality = 0; // Количество чисел в контейнере
+
+        bool contains(uint16_t low) const {
+            switch (type) {
+            case ContainerType::Array:
+                return std::binary_search(array.begin(), array.end(), low);
+            case ContainerType::Bitmap:
+                return (bitmap[low >> 6] >> (low & 63)) & 1;
+            default: {
+                // Последняя серия, начинающаяся не позже low
+                auto it = std::upper_bound(runs.begin(), runs.end(), std::make_pair(low, uint16_t(0xFFFF)));
+                if (it == runs.begin()) {
+                    return false;
+                }
+                --it;
+                return static_cast<uint32_t>(low) <= static_cast<uint32_t>(it->first) + it->second;
+            }
+            }
+        }
+
+        /// <summary>
+        /// Записывает все значения контейнера в битовую карту из 1024 слов.
+        /// </summary>
+        void fillWords(std::vector<uint64_t>& words) const {
+            words.assign(bitmapWords, 0);
+            switch (type) {
+            case ContainerType::Array:
+                for (uint16_t low : array) {
+                    words[low >> 6] |= uint64_t(1) << (low & 63);
+                }
+                break;
+            case ContainerType::Bitmap:
+                words = bitmap;
+                break;
+            default:
+                for (const auto& run : runs) {
+                    uint32_t last = static_cast<uint32_t>(run.first) + run.second;
+                    for (uint32_t low = run.first; low <= last; ++low) {
+                        words[low >> 6] |= uint64_t(1) << (low & 63);
+                    }
+                }
+                break;
+            }
+        }
+
+        /// <summary>
+        /// Выписывает все значения контейнера по возрастанию.
+        /// </summary>
+        void fillArray(std::vector<uint16_t>& values) const {
+            values.clear();
+            values.reserve(cardinality);
+            switch (type) {
+            case ContainerType::Array:
+                values = array;
+                break;
+            case ContainerType::Bitmap:
+                for (size_t w = 0; w < bitmapWords; ++w) {
+                    uint64_t word = bitmap[w];
+                    while (word != 0) {
+                        values.push_back(static_cast<uint16_t>(w * 64 + countTrailingZeros64(word)));
+                        word &= word - 1;
+                    }
+                }
+                break;
+            default:
+                for (const auto& run : runs) {
+                    uint32_t last = static_cast<uint32_t>(run.first) + run.second;
+                    for (uint32_t low = run.first; low <= last; ++low) {
+                        values.push_back(static_cast<uint16_t>(low));
+                    }
+                }
+                break;
+            }
+        }
+
+        /// <summary>
+        /// Делает контейнер массивом с данными значениями (или картой, если значений больше 4096).
+        /// </summary>
+        void assignArray(std::vector<uint16_t>&& values) {
+            runs.clear();
+            cardinality = static_cast<uint32_t>(values.size());
+            if (cardinality > arrayLimit) {
+                type = ContainerType::Bitmap;
+                bitmap.assign(bitmapWords, 0);
+                for (uint16_t low : values) {
+                    bitmap[low >> 6] |= uint64_t(1) << (low & 63);
+                }
+                array.clear();
+                array.shrink_to_fit();
+            }
+            else {
+                type = ContainerType::Array;
+                array = std::move(values);
+                bitmap.clear();
+                bitmap.shrink_to_fit();
+            }
+        }
+
+        /// <summary>
+        /// Делает контейнер картой с данными словами (или массивом, если значений не больше 4096).
+        /// </summary>
+        void assignWords(std::vector<uint64_t>&& words) {
+            uint32_t count = 0;
+            for (size_t w = 0; w < bitmapWords; ++w) {
+                count += popcount64(words[w]);
+            }
+            runs.clear();
+            type = ContainerType::Bitmap;
+            bitmap = std::move(words);
+            cardinality = count;
+            if (count <= arrayLimit) {
+                std::vector<uint16_t> values;
+                fillArray(values);
+                assignArray(std::move(values));
+            }
+        }
+
+        /// <summary>
+        /// Переводит контейнер-серию в массив или карту.
+        /// </summary>
+        void expandRuns() {
+            if (type != ContainerType::Run) {
+                return;
+            }
+            std::vector<uint16_t> values;
+            fillArray(values);
+            assignArray(std::move(values));
+        }
+
+        /// <summary>
+        /// После изменения серий: если серии стали занимать больше массива или карты
+        /// с теми же значениями, контейнер переводится в них (обратно к выбору optimize()).
+        /// </summary>
+        void expandRunsIfLarger() {
+            size_t otherBytes = cardinality > arrayLimit ? bitmapWords * 8 : cardinality * 2;
+            if (runs.size() * 4 > otherBytes) {
+                expandRuns();
+            }
+        }
+
+        /// <summary>
+        /// Вставка в контейнер-серию без разворачивания: число продлевает соседнюю серию,
+        /// склеивает две серии или становится новой серией длины 1.
+        /// </summary>
+        bool addToRuns(uint16_t low) {
+            if (contains(low)) {
+                return false;
+            }
+            // Первая серия, начинающаяся после low; предыдущая заканчивается раньше low - 1 или на low - 1
+            auto next = std::upper_bound(runs.begin(), runs.end(), std::make_pair(low, uint16_t(0xFFFF)));
+            bool joinsPrevious = next != runs.begin()
+                && static_cast<uint32_t>(std::prev(next)->first) + std::prev(next)->second + 1 == low;
+            bool joinsNext = next != runs.end() && static_cast<uint32_t>(low) + 1 == next->first;
+            if (joinsPrevious && joinsNext) {
+                auto previous = std::prev(next);
+                previous->second = static_cast<uint16_t>(previous->second + next->second + 2);
+                runs.erase(next);
+            }
+            else if (joinsPrevious) {
+                std::prev(next)->second++;
+            }
+            else if (joinsNext) {
+                next->first = low;
+                next->second++;
+            }
+            else {
+                runs.insert(next, std::make_pair(low, uint16_t(0)));
+            }
+            cardinality++;
+            expandRunsIfLarger();
+            return true;
+        }
+
+        /// <summary>
+        /// Удаление из контейнера-серии без разворачивания: серия укорачивается или делится на две.
+        /// </summary>
+        bool eraseFromRuns(uint16_t low) {
+            if (!contains(low)) {
+                return false;
+            }
+            auto run = std::prev(std::upper_bound(runs.begin(), runs.end(), std::make_pair(low, uint16_t(0xFFFF))));
+            uint32_t first = run->first;
+            uint32_t last = first + run->second;
+            if (first == last) {
+                runs.erase(run);
+            }
+            else if (low == first) {
+                run->first++;
+                run->second--;
+            }
+            else if (low == last) {
+                run->second--;
+            }
+            else {
+                run->second = static_cast<uint16_t>(low - first - 1);
+                runs.insert(std::next(run), std::make_pair(static_cast<uint16_t>(low + 1), static_cast<uint16_t>(last - low - 1)));
+            }
+            cardinality--;
+            if (cardinality != 0) {
+                expandRunsIfLarger();
+            }
+            return true;
+        }
+
+        bool add(uint16_t low) {
+            if (type == ContainerType::Run) {
+                return addToRuns(low);
+            }
+            if (type == ContainerType::Bitmap) {
+                uint64_t& word = bitmap[low >> 6];
+                uint64_t bit = uint64_t(1) << (low & 63);
+                if (word & bit) {
+                    return false;
+                }
+                word |= bit;
+                cardinality++;
+                return true;
+            }
+
+            auto it = std::lower_bound(array.begin(), array.end(), low);
+            if (it != array.end() && *it == low) {
+                return false;
+            }
+            array.insert(it, low);
+            cardinality++;
+            if (cardinality > arrayLimit) {
+                std::vector<uint16_t> values;
+                values.swap(array);
+                assignArray(std::move(values));
+            }
+            return true;
+        }
+
+        bool erase(uint16_t low) {
+            if (type == ContainerType::Run) {
+                return eraseFromRuns(low);
+            }
+            if (type == ContainerType::Bitmap) {
+                uint64_t& word = bitmap[low >> 6];
+                uint64_t bit = uint64_t(1) << (low & 63);
+                if (!(word & bit)) {
+                    return false;
+                }
+                word &= ~bit;
+                cardinality--;
+                if (cardinality <= arrayLimit) {
+                    std::vector<uint16_t> values;
+                    fillArray(values);
+                    assignArray(std::move(values));
+                }
+                return true;
+            }
+
+            auto it = std::lower_bound(array.begin(), array.end(), low);
+            if (it == array.end() || *it != low) {
+                return false;
+            }
+            array.erase(it);
+            cardinality--;
+            return true;
+        }
+
+        /// <summary>
+        /// Наименьшее значение контейнера, не меньшее from.
+        /// </summary>
+        /// <returns>false, если такого значения нет.</returns>
+        bool nextAtOrAfter(uint32_t from, uint16_t& out) const {
+            if (from > 0xFFFF) {
+                return false;
+            }
+            switch (type) {
+            case ContainerType::Array: {
+                auto it = std::lower_bound(array.begin(), array.end(), static_cast<uint16_t>(from));
+                if (it == array.end()) {
+                    return false;
+                }
+                out = *it;
+                return true;
+            }
+            case ContainerType::Bitmap: {
+                size_t w = from >> 6;
+                uint64_t word = bitmap[w] & (~uint64_t(0) << (from & 63));
+                while (true) {
+                    if (word != 0) {
+                        out = static_cast<uint16_t>(w * 64 + countTrailingZeros64(word));
+                        return true;
+                    }
+                    if (++w == bitmapWords) {
+                        return false;
+                    }
+                    word = bitmap[w];
+                }
+            }
+            default:
+                for (const auto& run : runs) {
+                    uint32_t last = static_cast<uint32_t>(run.first) + run.second;
+                    if (from <= last) {
+                        out = static_cast<uint16_t>(std::max<uint32_t>(from, run.first));
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+
+        /// <summary>
+        /// Переводит контейнер в серии, если так он занимает меньше памяти.
+        /// </summary>
+        void optimize() {
+            std::vector<uint16_t> values;
+            fillArray(values);
+            std::vector<std::pair<uint16_t, uint16_t>> newRuns;
+            for (size_t i = 0; i < values.size();) {
+                size_t j = i;
+                while (j + 1 < values.size() && values[j + 1] == values[j] + 1) {
+                    ++j;
+                }
+                newRuns.emplace_back(values[i], static_cast<uint16_t>(j - i));
+                i = j + 1;
+            }
+
+            size_t runBytes = newRuns.size() * 4;
+            size_t currentBytes = (type == ContainerType::Bitmap) ? bitmapWords * 8 : cardinality * 2;
+            if (runBytes < currentBytes) {
+                type = ContainerType::Run;
+                runs = std::move(newRuns);
+                array.clear();
+                array.shrink_to_fit();
+                bitmap.clear();
+                bitmap.shrink_to_fit();
+            }
+            else if (type == ContainerType::Run) {
+                assignArray(std::move(values));
+            }
+        }
+
+        size_t sizeInBytes() const {
+            return sizeof(Container) + array.capacity() * sizeof(uint16_t)
+                + bitmap.capacity() * sizeof(uint64_t) + runs.capacity() * sizeof(runs[0]);
+        }
+    };
+
+    std::vector<uint16_t> keys; // Старшие 16 бит блоков, по возрастанию
+    std::vector<Container> containers; // Контейнеры блоков, параллельно keys
+
+    /// <summary>
+    /// Применяет операцию к двум контейнерам одного блока.
+    /// Два массива объединяются слиянием отсортированных последовательностей,
+    /// пересечение/разность с массивом - проверкой каждого его элемента,
+    /// остальные случаи - пословным циклом по двум битовым картам.
+    /// </summary>
+    static Container combine(const Container& a, const Container& b, Operation op) {
+        Container result;
+
+        if (a.type == ContainerType::Array && b.type == ContainerType::Array) {
+            std::vector<uint16_t> values;
+            values.reserve(op == Operation::And ? std::min(a.array.size(), b.array.size()) : a.array.size() + b.array.size());
+            auto out = std::back_inserter(values);
+            switch (op) {
+            case Operation::Or:
+                std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), out);
+                break;
+            case Operation::And:
+                std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), out);
+                break;
+            case Operation::AndNot:
+                std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), out);
+                break;
+            case Operation::Xor:
+                std::set_symmetric_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), out);
+                break;
+            }
+            result.assignArray(std::move(values));
+            return result;
+        }
+
+        if ((op == Operation::And || op == Operation::AndNot) && a.type == ContainerType::Array) {
+            std::vector<uint16_t> values;
+            bool keepCommon = (op == Operation::And);
+            for (uint16_t low : a.array) {
+                if (b.contains(low) == keepCommon) {
+                    values.push_back(low);
+                }
+            }
+            result.assignArray(std::move(values));
+            return result;
+        }
+        if (op == Operation::And && b.type == ContainerType::Array) {
+            return combine(b, a, op);
+        }
+
+        std::vector<uint64_t> words;
+        std::vector<uint64_t> other;
+        a.fillWords(words);
+        b.fillWords(other);
+        uint64_t* __restrict left = words.data();
+        const uint64_t* __restrict right = other.data();
+        switch (op) {
+        case Operation::Or:
+            for (size_t w = 0; w < bitmapWords; ++w) left[w] |= right[w];
+            break;
+        case Operation::And:
+            for (size_t w = 0; w < bitmapWords; ++w) left[w] &= right[w];
+            break;
+        case Operation::AndNot:
+            for (size_t w = 0; w < bitmapWords; ++w) left[w] &= ~right[w];
+            break;
+        case Operation::Xor:
+            for (size_t w = 0; w < bitmapWords; ++w) left[w] ^= right[w];
+            break;
+        }
+        result.assignWords(std::move(words));
+        return result;
+    }
+
+    /// <summary>
+    /// Применяет операцию к двум множествам: блоки сливаются по возрастанию старших 16 бит.
+    /// </summary>
+    static RoaringBitmap combine(const RoaringBitmap& a, const RoaringBitmap& b, Operation op) {
+        RoaringBitmap result;
+        bool keepOnlyA = (op != Operation::And);
+        bool keepOnlyB = (op == Operation::Or || op == Operation::Xor);
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.keys.size() || j < b.keys.size()) {
+            if (j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j])) {
+                if (keepOnlyA) {
+                    result.keys.push_back(a.keys[i]);
+                    result.containers.push_back(a.containers[i]);
+                }
+                ++i;
+            }
+            else if (i == a.keys.size() || b.keys[j] < a.keys[i]) {
+                if (keepOnlyB) {
+                    result.keys.push_back(b.keys[j]);
+                    result.containers.push_back(b.containers[j]);
+                }
+                ++j;
+            }
+            else {
+                Container merged = combine(a.containers[i], b.containers[j], op);
+                if (merged.cardinality != 0) {
+                    result.keys.push_back(a.keys[i]);
+                    result.containers.push_back(std::move(merged));
+                }
+                ++i;
+                ++j;
+            }
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Индекс блока с данными старшими битами или keys.size().
+    /// </summary>
+    size_t findChunk(uint16_t high) const {
+        auto it = std::lower_bound(keys.begin(), keys.end(), high);
+        if (it == keys.end() || *it != high) {
+            return keys.size();
+        }
+        return static_cast<size_t>(it - keys.begin());
+    }
+
+public:
+    /// <summary>
+    /// Добавляет число в множество.
+    /// </summary>
+    /// <returns>true, если число было добавлено, false - если оно уже было.</returns>
+    bool insert(uint32_t value) {
+        uint16_t high = static_cast<uint16_t>(value >> 16);
+        auto it = std::lower_bound(keys.begin(), keys.end(), high);
+        size_t index = static_cast<size_t>(it - keys.begin());
+        if (it == keys.end() || *it != high) {
+            keys.insert(it, high);
+            containers.insert(containers.begin() + index, Container());
+        }
+        return containers[index].add(static_cast<uint16_t>(value));
+    }
+
+    /// <summary>
+    /// Проверяет наличие числа в множестве.
+    /// </summary>
+    bool contains(uint32_t value) const {
+        size_t index = findChunk(static_cast<uint16_t>(value >> 16));
+        return index != keys.size() && containers[index].contains(static_cast<uint16_t>(value));
+    }
+
+    /// <summary>
+    /// Удаляет число из множества. Пустые блоки удаляются.
+    /// </summary>
+    /// <returns>true, если число было удалено, false - если его не было.</returns>
+    bool erase(uint32_t value) {
+        size_t index = findChunk(static_cast<uint16_t>(value >> 16));
+        if (index == keys.size() || !containers[index].erase(static_cast<uint16_t>(value))) {
+            return false;
+        }
+        if (containers[index].cardinality == 0) {
+            keys.erase(keys.begin() + index);
+            containers.erase(containers.begin() + index);
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Количество чисел в множестве (сумма мощностей контейнеров).
+    /// </summary>
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& container : containers) {
+            total += container.cardinality;
+        }
+        return total;
+    }
+
+    void clear() {
+        keys.clear();
+        containers.clear();
+    }
+
+    /// <summary>
+    /// Переводит в серии те контейнеры, которым так выгоднее (плотные непрерывные диапазоны).
+    /// </summary>
+    void runOptimize() {
+        for (auto& container : containers) {
+            container.optimize();
+        }
+    }
+
+    /// <summary>
+    /// Приблизительный объём памяти, занимаемый множеством, в байтах.
+    /// </summary>
+    size_t sizeInBytes() const {
+        size_t total = sizeof(RoaringBitmap) + keys.capacity() * sizeof(uint16_t);
+        for (const auto& container : containers) {
+            total += container.sizeInBytes();
+        }
+        return total;
+    }
+
+    /// <summary>
+    /// Наименьшее число множества, не меньшее from.
+    /// </summary>
+    /// <returns>false, если такого числа нет.</returns>
+    bool nextAtOrAfter(uint64_t from, uint32_t& out) const {
+        if (from > 0xFFFFFFFFULL) {
+            return false;
+        }
+        uint16_t high = static_cast<uint16_t>(from >> 16);
+        size_t index = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), high) - keys.begin());
+        for (; index < keys.size(); ++index) {
+            uint32_t low = (keys[index] == high) ? static_cast<uint32_t>(from & 0xFFFF) : 0;
+            uint16_t found;
+            if (containers[index].nextAtOrAfter(low, found)) {
+                out = (static_cast<uint32_t>(keys[index]) << 16) | found;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// Обходит все числа по возрастанию.
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        std::vector<uint16_t> values;
+        for (size_t index = 0; index < keys.size(); ++index) {
+            uint32_t high = static_cast<uint32_t>(keys[index]) << 16;
+            containers[index].fillArray(values);
+            for (uint16_t low : values) {
+                visit(high | low);
+            }
+        }
+    }
+
+    RoaringBitmap operator|(const RoaringBitmap& other) const {
+        return combine(*this, other, Operation::Or);
+    }
+
+    RoaringBitmap operator&(const RoaringBitmap& other) const {
+        return combine(*this, other, Operation::And);
+    }
+
+    RoaringBitmap operator-(const RoaringBitmap& other) const {
+        return combine(*this, other, Operation::AndNot);
+    }
+
+    RoaringBitmap operator^(const RoaringBitmap& other) const {
+        return combine(*this, other, Operation::Xor);
+    }
+};
+
+/// <summary>
+/// Множество целых чисел (до 32 бит) с тем же интерфейсом, что и Set, но на основе RoaringBitmap.
+/// Для плотных и кластеризованных идентификаторов занимает 2 байта на число или меньше
+/// (против 40+ байт на узел std::list в Set), а операции над множествами идут пословно по битовым картам.
+/// Обход идёт по возрастанию значений (беззнаковому, то есть отрицательные числа идут после положительных).
+/// </summary>
+/// <typeparam name="Value">Целочисленный тип размером не больше 32 бит</typeparam>
+template <typename Value>
+class RoaringSet {
+    static_assert(std::is_integral<Value>::value && sizeof(Value) <= 4, "RoaringSet requires an integral type of at most 32 bits");
+
+private:
+    RoaringBitmap bitmap; // Сжатое представление множества
+
+    explicit RoaringSet(RoaringBitmap&& other) : bitmap(std::move(other)) {}
+
+    static uint32_t toKey(const Value& value) {
+        return static_cast<uint32_t>(static_cast<typename std::make_unsigned<Value>::type>(value));
+    }
+
+    static Value fromKey(uint32_t key) {
+        return static_cast<Value>(static_cast<typename std::make_unsigned<Value>::type>(key));
+    }
+
+public:
+    RoaringSet() {}
+
+    class Iterator;
+
+    /// <summary>
+    /// Вставка элемента в множество. Если элемент уже существует, повторная вставка не происходит.
+    /// </summary>
+    /// <returns>Пара (итератор на элемент, true если элемент был вставлен) - как у Set::insert.</returns>
+    std::pair<Iterator, bool> insert(const Value& value) {
+        bool inserted = bitmap.insert(toKey(value));
+        return std::make_pair(Iterator(&bitmap, toKey(value)), inserted);
+    }
+
+    bool contains(const Value& value) const {
+        return bitmap.contains(toKey(value));
+    }
+
+    /// <summary>
+    /// Удаление элемента из множества.
+    /// Если элемент не найден, будет сгенерировано исключение runtime_error (как в Set).
+    /// </summary>
+    void remove(const Value& value) {
+        if (!bitmap.erase(toKey(value))) {
+            throw std::runtime_error("Key not found");
+        }
+    }
+
+    void clear() {
+        bitmap.clear();
+    }
+
+    size_t size() const {
+        return bitmap.size();
+    }
+
+    /// <summary>
+    /// Для совместимости с Set: сжатому множеству резервировать нечего.
+    /// </summary>
+    void reserve(size_t) {}
+
+    /// <summary>
+    /// Переводит плотные диапазоны в серии (см. RoaringBitmap::runOptimize).
+    /// </summary>
+    void runOptimize() {
+        bitmap.runOptimize();
+    }
+
+    size_t sizeInBytes() const {
+        return bitmap.sizeInBytes();
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        bitmap.forEach([&visit](uint32_t key) {
+            visit(fromKey(key));
+        });
+    }
+
+    RoaringSet operator|(const RoaringSet& other) const {
+        return RoaringSet(bitmap | other.bitmap);
+    }
+
+    RoaringSet operator&(const RoaringSet& other) const {
+        return RoaringSet(bitmap & other.bitmap);
+    }
+
+    RoaringSet operator-(const RoaringSet& other) const {
+        return RoaringSet(bitmap - other.bitmap);
+    }
+
+    RoaringSet operator^(const RoaringSet& other) const {
+        return RoaringSet(bitmap ^ other.bitmap);
+    }
+
+    bool isSubsetOf(const RoaringSet& other) const {
+        return size() <= other.size() && (bitmap - other.bitmap).size() == 0;
+    }
+
+    bool isDisjoint(const RoaringSet& other) const {
+        return (bitmap & other.bitmap).size() == 0;
+    }
+
+    /// <summary>
+    /// Итератор множества, обходит элементы по возрастанию.
+    /// </summary>
+    class Iterator {
+    private:
+        const RoaringBitmap* bitmap; // Обходимое множество
+        uint64_t current; // Текущее число; 2^32 обозначает конец
+
+    public:
+        Iterator(const RoaringBitmap* source, uint64_t from) : bitmap(source), current(0x100000000ULL) {
+            uint32_t found;
+            if (bitmap->nextAtOrAfter(from, found)) {
+                current = found;
+            }
+        }
+
+        Value operator*() const {
+            return fromKey(static_cast<uint32_t>(current));
+        }
+
+        Iterator& operator++() {
+            uint32_t found;
+            current = bitmap->nextAtOrAfter(current + 1, found) ? found : 0x100000000ULL;
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return current == other.current;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    Iterator begin() const {
+        return Iterator(&bitmap, 0);
+    }
+
+    Iterator end() const {
+        return Iterator(&bitmap, 0x100000000ULL);
+    }
+
+    /// <summary>
+    /// Функция для тестирования RoaringSet
+    /// </summary>
+    static void testRoaringSet() {
+        RoaringSet<int> ids;
+        assert(ids.size() == 0);
+        assert(ids.insert(1).second);
+        assert(ids.insert(2).second);
+        auto duplicate = ids.insert(2); // Дубликат
+        assert(!duplicate.second && *duplicate.first == 2);
+        assert(ids.insert(-5).second);
+        assert(ids.contains(1) && ids.contains(-5) && !ids.contains(3));
+        ids.remove(2);
+        assert(!ids.contains(2) && ids.size() == 2);
+        try {
+            ids.remove(2);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        // Переход массив -> битовая карта -> массив внутри одного блока
+        RoaringSet<uint32_t> dense;
+        for (uint32_t i = 0; i < 10000; ++i) {
+            dense.insert(i * 3);
+        }
+        assert(dense.size() == 10000);
+        assert(dense.contains(29997) && !dense.contains(29998));
+        for (uint32_t i = 0; i < 9000; ++i) {
+            dense.remove(i * 3);
+        }
+        assert(dense.size() == 1000);
+        assert(dense.contains(27000) && !dense.contains(26997));
+
+        // Серии сжимают непрерывный диапазон
+        RoaringSet<uint32_t> range;
+        for (uint32_t i = 100000; i < 200000; ++i) {
+            range.insert(i);
+        }
+        size_t before = range.sizeInBytes();
+        range.runOptimize();
+        assert(range.sizeInBytes() < before / 20);
+        assert(range.contains(100000) && range.contains(199999) && !range.contains(200000));
+        range.insert(5); // Изменение контейнера-серии
+        range.remove(150000);
+        assert(range.size() == 100000);
+        assert(!range.contains(150000) && range.contains(150001));
+        range.insert(200000); // Продление серии
+        range.insert(150000); // Склейка двух серий
+        range.remove(100000); // Укорачивание серии с начала
+        range.insert(99998); // Новая серия
+        assert(range.size() == 100002);
+        assert(range.sizeInBytes() < before / 20); // Изменения не разворачивают серии
+        assert(range.contains(99998) && !range.contains(99999) && !range.contains(100000));
+        assert(range.contains(100001) && range.contains(150000) && range.contains(200000));
+
+        // Серии, ставшие невыгодными, переводятся обратно в массив
+        RoaringSet<uint32_t> sparseRuns;
+        sparseRuns.insert(10);
+        sparseRuns.insert(11);
+        sparseRuns.runOptimize();
+        for (uint32_t i = 20; i < 200; i += 2) {
+            sparseRuns.insert(i);
+        }
+        assert(sparseRuns.size() == 92 && sparseRuns.contains(11) && sparseRuns.contains(198) && !sparseRuns.contains(199));
+
+        // Операции над множествами сверяются с Set
+        RoaringSet<uint32_t> a;
+        RoaringSet<uint32_t> b;
+        Set<uint32_t> hashA;
+        Set<uint32_t> hashB;
+        for (uint32_t i = 0; i < 200000; i += 2) {
+            a.insert(i);
+            hashA.insert(i);
+        }
+        for (uint32_t i = 0; i < 300000; i += 7) {
+            b.insert(i);
+            hashB.insert(i);
+        }
+        b.runOptimize();
+        assert((a | b).size() == (hashA | hashB).size());
+        assert((a & b).size() == (hashA & hashB).size());
+        assert((a - b).size() == (hashA - hashB).size());
+        assert((a ^ b).size() == (hashA ^ hashB).size());
+        assert((a & b).isSubsetOf(a) && !a.isSubsetOf(b));
+        assert((a - b).isDisjoint(b) && !a.isDisjoint(b));
+
+        // Обход по возрастанию
+        RoaringSet<uint32_t> ordered;
+        ordered.insert(70000);
+        ordered.insert(3);
+        ordered.insert(65536);
+        std::vector<uint32_t> walked;
+        for (auto it = ordered.begin(); it != ordered.end(); ++it) {
+            walked.push_back(*it);
+        }
+        assert((walked == std::vector<uint32_t>{ 3, 65536, 70000 }));
+
+        size_t counted = 0;
+        a.forEach([&](uint32_t value) {
+            assert(hashA.contains(value));
+            counted++;
+        });
+        assert(counted == a.size());
+
+        std::cout << "All ROARING SET tests passed!" << std::endl;
+    }
+};
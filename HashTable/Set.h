@@ -4,6 +4,10 @@
 #include <functional>
 #include <stdexcept>
 #include <utility>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <type_traits>
 #include "HashTable.h"
 
 /// <summary>
@@ -19,6 +23,123 @@ class Set {
 private:
     HashTable<Value> hashTable; // Хеш-таблица для хранения элементов множества
 
+    // Начиная с этого числа элементов операции над множествами делят ведра между потоками
+    static const size_t parallelThreshold = 1 << 16;
+
+    /// <summary>
+    /// Сколько потоков использовать для обхода множества данного размера.
+    /// </summary>
+    static unsigned threadCountFor(size_t elements) {
+        if (elements < parallelThreshold) {
+            return 1;
+        }
+        unsigned hardware = std::thread::hardware_concurrency();
+        size_t byWork = elements / (parallelThreshold / 2);
+        unsigned threads = hardware == 0 ? 2 : hardware;
+        return static_cast<unsigned>(std::min<size_t>(threads, byWork));
+    }
+
+    /// <summary>
+    /// Отбирает элементы source, для которых keep возвращает true.
+    /// Большие множества обходятся параллельно: каждый поток получает свой диапазон ведер
+    /// и складывает найденное в локальный вектор, затем векторы склеиваются.
+    /// </summary>
+    /// <param name="source">Множество, которое обходится.</param>
+    /// <param name="keep">Предикат отбора (вызывается из нескольких потоков, должен только читать).</param>
+    /// <returns>Отобранные элементы, без повторов.</returns>
+    template <typename Predicate>
+    static std::vector<Value> select(const Set& source, Predicate keep) {
+        size_t buckets = source.hashTable.capacity();
+        unsigned threads = threadCountFor(source.size());
+        if (threads <= 1) {
+            std::vector<Value> selected;
+            source.hashTable.forEachInBuckets(0, buckets, [&](const Value& value) {
+                if (keep(value)) {
+                    selected.push_back(value);
+                }
+            });
+            return selected;
+        }
+
+        std::vector<std::vector<Value>> parts(threads);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            size_t first = buckets * t / threads;
+            size_t last = buckets * (t + 1) / threads;
+            workers.emplace_back([&source, &parts, &keep, t, first, last]() {
+                source.hashTable.forEachInBuckets(first, last, [&](const Value& value) {
+                    if (keep(value)) {
+                        parts[t].push_back(value);
+                    }
+                });
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        size_t total = 0;
+        for (const auto& part : parts) {
+            total += part.size();
+        }
+        std::vector<Value> selected;
+        selected.reserve(total);
+        for (auto& part : parts) {
+            std::move(part.begin(), part.end(), std::back_inserter(selected));
+        }
+        return selected;
+    }
+
+    /// <summary>
+    /// Проверяет, что predicate выполняется для всех элементов source.
+    /// Большие множества проверяются параллельно по диапазонам ведер, с общим флагом ранней остановки.
+    /// </summary>
+    template <typename Predicate>
+    static bool allOf(const Set& source, Predicate predicate) {
+        size_t buckets = source.hashTable.capacity();
+        unsigned threads = threadCountFor(source.size());
+        std::atomic<bool> holds(true);
+        auto scan = [&](size_t first, size_t last) {
+            for (size_t bucket = first; bucket < last && holds.load(std::memory_order_relaxed); ++bucket) {
+                source.hashTable.forEachInBuckets(bucket, bucket + 1, [&](const Value& value) {
+                    if (!predicate(value)) {
+                        holds.store(false, std::memory_order_relaxed);
+                    }
+                });
+            }
+        };
+
+        if (threads <= 1) {
+            scan(0, buckets);
+            return holds.load();
+        }
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back(scan, buckets * t / threads, buckets * (t + 1) / threads);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return holds.load();
+    }
+
+    /// <summary>
+    /// Собирает множество из заведомо уникальных элементов: емкость резервируется заранее,
+    /// проверка на дубликат не нужна.
+    /// </summary>
+    static Set fromUnique(const std::vector<Value>& first, const std::vector<Value>& second = std::vector<Value>()) {
+        Set result;
+        result.hashTable.reserve(first.size() + second.size());
+        for (const auto& value : first) {
+            result.hashTable.insert(value);
+        }
+        for (const auto& value : second) {
+            result.hashTable.insert(value);
+        }
+        return result;
+    }
+
 public:
     /// <summary>
     /// Конструктор класса Set.
@@ -30,16 +151,112 @@ public:
     Set(size_t capacity = 10, double maxLoad = 0.7)
         : hashTable([](const Value& key) { return fnv1aHash<Value>(key); }, capacity, maxLoad) {}
 
+    class Iterator;
+
     /// <summary>
     /// Вставка элемента в множество с проверкой на дубликат.
     /// Если элемент уже существует, повторная вставка не происходит.
+    /// Проверка и вставка выполняются за один проход по ведру (хеш считается один раз).
     /// </summary>
     /// <param name="value">Элемент, который необходимо вставить в множество.</param>
-    /// <returns>Нет возвращаемого значения.</returns>
-    void insert(const Value& value) {
-        if (!hashTable.contains(value)) { // Проверка на существование элемента 
-            hashTable.insert(value); // Вставка, только если элемента нет 
+    /// <returns>Пара (итератор на элемент в множестве, true если элемент был вставлен).</returns>
+    std::pair<Iterator, bool> insert(const Value& value) {
+        auto result = hashTable.insertUnique(value);
+        return std::make_pair(Iterator(result.first), result.second);
+    }
+
+    /// <summary>
+    /// Строит множество из диапазона с повторами, удаляя дубликаты в несколько потоков.
+    /// 1. Каждый поток раскладывает свой кусок входа по partitions частям по хешу элемента.
+    /// 2. Каждый поток собирает одну часть из кусков всех потоков в своё множество
+    ///    (одинаковые элементы всегда попадают в одну часть, поэтому части не пересекаются).
+    /// 3. Части сливаются в результат без проверки на дубликаты.
+    /// Диапазон проходится несколько раз (длина, границы кусков, потоки), поэтому нужны
+    /// однонаправленные итераторы; границы кусков находятся одним проходом.
+    /// </summary>
+    /// <param name="first">Начало диапазона.</param>
+    /// <param name="last">Конец диапазона.</param>
+    /// <param name="threads">Количество потоков (0 - по числу ядер).</param>
+    /// <returns>Множество уникальных элементов диапазона.</returns>
+    /// <BigO>O(n / threads + u) в среднем, где u - число уникальных элементов</BigO>
+    template <typename ForwardIt>
+    static Set from_range(ForwardIt first, ForwardIt last, unsigned threads = 0) {
+        static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>::value,
+            "Set::from_range requires forward iterators");
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        Set result;
+        if (threads == 1 || n < parallelThreshold) {
+            for (; first != last; ++first) {
+                result.hashTable.insertUnique(*first);
+            }
+            return result;
+        }
+
+        // Номер части берётся из перемешанного хеша, чтобы не коррелировать с номером ведра (хеш % ёмкость)
+        auto partitionOf = [threads](const Value& value) {
+            return intMixHash<size_t>(fnv1aHash<Value>(value)) % threads;
+        };
+
+        // Границы кусков: bounds[t] - начало куска t (для итераторов без произвольного доступа - O(n) всего)
+        std::vector<ForwardIt> bounds;
+        bounds.reserve(threads + 1);
+        bounds.push_back(first);
+        for (unsigned t = 1; t <= threads; ++t) {
+            ForwardIt next = bounds.back();
+            std::advance(next, n * t / threads - n * (t - 1) / threads);
+            bounds.push_back(next);
+        }
+
+        std::vector<std::vector<std::vector<Value>>> scattered(threads, std::vector<std::vector<Value>>(threads));
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            ForwardIt sliceFirst = bounds[t];
+            ForwardIt sliceLast = bounds[t + 1];
+            workers.emplace_back([&scattered, &partitionOf, t, sliceFirst, sliceLast]() {
+                for (ForwardIt it = sliceFirst; it != sliceLast; ++it) {
+                    scattered[t][partitionOf(*it)].push_back(*it);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+
+        std::vector<Set> parts(threads);
+        for (unsigned p = 0; p < threads; ++p) {
+            workers.emplace_back([&scattered, &parts, threads, p]() {
+                size_t incoming = 0;
+                for (unsigned t = 0; t < threads; ++t) {
+                    incoming += scattered[t][p].size();
+                }
+                parts[p].hashTable.reserve(incoming);
+                for (unsigned t = 0; t < threads; ++t) {
+                    for (const auto& value : scattered[t][p]) {
+                        parts[p].hashTable.insertUnique(value);
+                    }
+                    std::vector<Value>().swap(scattered[t][p]); // Освобождаем память куска сразу
+                }
+            });
         }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        size_t unique = 0;
+        for (const auto& part : parts) {
+            unique += part.size();
+        }
+        result.hashTable.reserve(unique);
+        for (const auto& part : parts) {
+            part.forEach([&result](const Value& value) {
+                result.hashTable.insert(value);
+            });
+        }
+        return result;
     }
 
     /// <summary>
@@ -78,6 +295,118 @@ public:
         return hashTable.size();
     }
 
+    /// <summary>
+    /// Резервирует место под n элементов.
+    /// </summary>
+    /// <param name="n">Ожидаемое количество элементов.</param>
+    void reserve(size_t n) {
+        hashTable.reserve(n);
+    }
+
+    /// <summary>
+    /// Обходит все элементы множества без копирования.
+    /// </summary>
+    /// <param name="visit">Функция, вызываемая для каждого элемента.</param>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        hashTable.forEachInBuckets(0, hashTable.capacity(), visit);
+    }
+
+    /// <summary>
+    /// Объединение множеств. Копируется большее множество, в него досыпаются
+    /// элементы меньшего, которых там нет.
+    /// </summary>
+    /// <BigO>O(n + m) в среднем, где n, m - размеры множеств</BigO>
+    Set operator|(const Set& other) const {
+        const Set& larger = size() >= other.size() ? *this : other;
+        const Set& smaller = size() >= other.size() ? other : *this;
+
+        std::vector<Value> missing = select(smaller, [&larger](const Value& value) {
+            return !larger.contains(value);
+        });
+
+        Set result(larger);
+        result.hashTable.reserve(larger.size() + missing.size());
+        for (const auto& value : missing) {
+            result.hashTable.insert(value);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Пересечение множеств. Обходится меньшее множество, проверка идёт в большем.
+    /// </summary>
+    /// <BigO>O(min(n, m)) в среднем</BigO>
+    Set operator&(const Set& other) const {
+        const Set& larger = size() >= other.size() ? *this : other;
+        const Set& smaller = size() >= other.size() ? other : *this;
+
+        return fromUnique(select(smaller, [&larger](const Value& value) {
+            return larger.contains(value);
+        }));
+    }
+
+    /// <summary>
+    /// Разность множеств (элементы this, которых нет в other).
+    /// Если other меньше, копируется this и из копии удаляются общие элементы.
+    /// </summary>
+    /// <BigO>O(min(n, m)) проверок в среднем (плюс копирование при малом other)</BigO>
+    Set operator-(const Set& other) const {
+        if (other.size() < size()) {
+            std::vector<Value> common = select(other, [this](const Value& value) {
+                return contains(value);
+            });
+            Set result(*this);
+            for (const auto& value : common) {
+                result.hashTable.remove(value);
+            }
+            return result;
+        }
+
+        return fromUnique(select(*this, [&other](const Value& value) {
+            return !other.contains(value);
+        }));
+    }
+
+    /// <summary>
+    /// Симметрическая разность множеств (элементы, которые есть ровно в одном из множеств).
+    /// </summary>
+    /// <BigO>O(n + m) в среднем</BigO>
+    Set operator^(const Set& other) const {
+        std::vector<Value> onlyHere = select(*this, [&other](const Value& value) {
+            return !other.contains(value);
+        });
+        std::vector<Value> onlyThere = select(other, [this](const Value& value) {
+            return !contains(value);
+        });
+        return fromUnique(onlyHere, onlyThere);
+    }
+
+    /// <summary>
+    /// Проверяет, что все элементы этого множества есть в other.
+    /// </summary>
+    /// <BigO>O(n) в среднем, O(1) если this больше other</BigO>
+    bool isSubsetOf(const Set& other) const {
+        if (size() > other.size()) {
+            return false;
+        }
+        return allOf(*this, [&other](const Value& value) {
+            return other.contains(value);
+        });
+    }
+
+    /// <summary>
+    /// Проверяет, что у множеств нет общих элементов. Обходится меньшее множество.
+    /// </summary>
+    /// <BigO>O(min(n, m)) в среднем</BigO>
+    bool isDisjoint(const Set& other) const {
+        const Set& larger = size() >= other.size() ? *this : other;
+        const Set& smaller = size() >= other.size() ? other : *this;
+        return allOf(smaller, [&larger](const Value& value) {
+            return !larger.contains(value);
+        });
+    }
+
     /// <summary>
     /// Итератор множества. Можно унаследовать
     /// </summary>
@@ -88,7 +417,7 @@ public:
     public:
         Iterator(typename HashTable<Value>::Iterator it) : hashTableIterator(it) {}
 
-        Value& operator*() {
+        const Value& operator*() const {
             return *hashTableIterator;
         }
 
@@ -170,6 +499,81 @@ public:
         strSet.clear();
         assert(strSet.size() == 0); // Проверяем, что множество пустое после очистки
 
+        // Вставка возвращает итератор на элемент и признак вставки
+        Set<int> probed;
+        auto firstInsert = probed.insert(42);
+        assert(firstInsert.second && *firstInsert.first == 42);
+        auto secondInsert = probed.insert(42);
+        assert(!secondInsert.second && *secondInsert.first == 42);
+        assert(probed.size() == 1);
+        assert(firstInsert.first != probed.end());
+
+        // Параллельное построение из диапазона с повторами
+        std::vector<int> withDuplicates;
+        for (int i = 0; i < 4 * static_cast<int>(parallelThreshold); ++i) {
+            withDuplicates.push_back(i % 50000);
+        }
+        Set<int> deduped = Set<int>::from_range(withDuplicates.begin(), withDuplicates.end(), 4);
+        assert(deduped.size() == 50000);
+        assert(deduped.contains(0) && deduped.contains(49999) && !deduped.contains(50000));
+        std::list<int> listed(withDuplicates.begin(), withDuplicates.end()); // Итераторы без произвольного доступа
+        assert(Set<int>::from_range(listed.begin(), listed.end(), 3).size() == 50000);
+        std::vector<std::string> words = { "a", "b", "a", "c", "b" };
+        assert(Set<std::string>::from_range(words.begin(), words.end()).size() == 3);
+
+        // Операции над множествами
+        Set<int> a;
+        Set<int> b;
+        for (int i = 0; i < 10; ++i) {
+            a.insert(i); // 0..9
+        }
+        for (int i = 5; i < 20; ++i) {
+            b.insert(i); // 5..19
+        }
+
+        Set<int> unionAB = a | b;
+        assert(unionAB.size() == 20);
+        assert(unionAB.contains(0) && unionAB.contains(19));
+
+        Set<int> interAB = a & b;
+        assert(interAB.size() == 5);
+        assert(interAB.contains(5) && interAB.contains(9) && !interAB.contains(4));
+
+        Set<int> diffAB = a - b;
+        assert(diffAB.size() == 5);
+        assert(diffAB.contains(0) && !diffAB.contains(5));
+
+        Set<int> diffBA = b - a; // Ветка с копированием большего множества
+        assert(diffBA.size() == 10);
+        assert(diffBA.contains(10) && !diffBA.contains(9));
+
+        Set<int> symAB = a ^ b;
+        assert(symAB.size() == 15);
+        assert(symAB.contains(0) && symAB.contains(19) && !symAB.contains(7));
+
+        assert(interAB.isSubsetOf(a) && interAB.isSubsetOf(b));
+        assert(!a.isSubsetOf(b));
+        assert(diffAB.isDisjoint(b));
+        assert(!a.isDisjoint(b));
+        assert(Set<int>().isSubsetOf(a) && Set<int>().isDisjoint(a));
+
+        // Большие множества проходят через параллельную ветку
+        Set<int> evens;
+        Set<int> threes;
+        const int bigN = 3 * static_cast<int>(parallelThreshold);
+        for (int i = 0; i < bigN; i += 2) {
+            evens.insert(i);
+        }
+        for (int i = 0; i < bigN; i += 3) {
+            threes.insert(i);
+        }
+        Set<int> sixes = evens & threes;
+        assert(sixes.size() == static_cast<size_t>((bigN + 5) / 6));
+        assert(sixes.isSubsetOf(evens) && sixes.isSubsetOf(threes));
+        assert((evens - threes).isDisjoint(threes));
+        assert((evens | threes).size() == evens.size() + threes.size() - sixes.size());
+        assert((evens ^ threes).size() == evens.size() + threes.size() - 2 * sixes.size());
+
         // Если все проверки прошли успешно
         std::cout << "All SET tests passed!" << std::endl;
     }
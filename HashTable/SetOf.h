@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <type_traits>
+#include <string>
+#include "Set.h"
+#include "IntHashTable.h"
+#include "RoaringBitmap.h"
+
+/// <summary>
+/// Реализация множества, выбираемая параметром шаблона SetOf.
+/// </summary>
+enum class SetBackend {
+    Hash, // Set: хеш-таблица с цепочками, любые типы
+    Roaring, // RoaringSet: сжатые битовые карты, целые до 32 бит
+    OpenAddressing // IntSet: хеш-таблица с открытой адресацией в плоском массиве, целые числа
+};
+
+template <typename Value, SetBackend Backend>
+struct SetSelector {
+    using type = Set<Value>;
+};
+
+template <typename Value>
+struct SetSelector<Value, SetBackend::Roaring> {
+    using type = RoaringSet<Value>;
+};
+
+template <typename Value>
+struct SetSelector<Value, SetBackend::OpenAddressing> {
+    using type = IntSet<Value>;
+};
+
+/// <summary>
+/// Множество с выбранной реализацией, например SetOf<int, SetBackend::Roaring>.
+/// Все реализации имеют интерфейс Set. По умолчанию целые числа хранятся в IntSet, остальные типы - в Set.
+/// </summary>
+template <typename Value, SetBackend Backend = std::is_integral<Value>::value ? SetBackend::OpenAddressing : SetBackend::Hash>
+using SetOf = typename SetSelector<Value, Backend>::type;
+
+static_assert(std::is_same<SetOf<int>, IntSet<int>>::value, "Integers default to open addressing");
+static_assert(std::is_same<SetOf<std::string>, Set<std::string>>::value, "Other types use Set");
+static_assert(std::is_same<SetOf<int, SetBackend::Hash>, Set<int>>::value, "Explicit hash backend");
+static_assert(std::is_same<SetOf<uint32_t, SetBackend::Roaring>, RoaringSet<uint32_t>>::value, "Explicit roaring backend");
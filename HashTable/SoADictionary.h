@@ -0,0 +1,387 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+
+/// <summary>
+/// Словарь с числовыми значениями в раскладке "структура массивов" (SoA).
+/// Ключи, их хеши и значения лежат в трёх отдельных плотных массивах с общими номерами,
+/// а поиск по ключу идёт через таблицу индексов (открытая адресация, линейное пробирование,
+/// ячейки uint32 с номером + 1). Массив значений доступен целиком через values(), поэтому
+/// сумма, фильтр по порогу или поиск максимума - это простой цикл по непрерывному массиву,
+/// который компилятор векторизует, без обхода узлов и копирования пар.
+/// Удаление переносит последнюю пару на место удалённой (порядок не сохраняется).
+/// </summary>
+/// <typeparam name="Key">Тип ключа</typeparam>
+/// <typeparam name="Value">Арифметический тип значения</typeparam>
+template <typename Key, typename Value>
+class SoADictionary {
+    static_assert(std::is_arithmetic<Value>::value, "SoADictionary requires an arithmetic value type");
+
+private:
+    std::vector<Key> keyArray; // Ключи
+    std::vector<size_t> hashArray; // Хеши ключей (для перестройки индекса и быстрого отсева)
+    std::vector<Value> valueArray; // Значения
+    std::vector<uint32_t> slots; // Таблица индексов: 0 - пусто, иначе номер пары + 1
+    size_t mask; // slots.size() - 1, размер - степень двойки
+
+    size_t homeSlot(size_t hash) const {
+        return static_cast<size_t>(mix64(hash)) & mask;
+    }
+
+    /// <summary>
+    /// Ищет ячейку индекса с ключом.
+    /// </summary>
+    /// <returns>Номер ячейки или slots.size(), если ключа нет.</returns>
+    size_t findSlot(const Key& key, size_t hash) const {
+        for (size_t slot = homeSlot(hash);; slot = (slot + 1) & mask) {
+            uint32_t value = slots[slot];
+            if (value == 0) {
+                return slots.size();
+            }
+            if (hashArray[value - 1] == hash && keyArray[value - 1] == key) {
+                return slot;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Ячейка индекса, указывающая на пару с данным номером.
+    /// </summary>
+    size_t slotOf(size_t position) const {
+        size_t slot = homeSlot(hashArray[position]);
+        while (slots[slot] != position + 1) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void rebuildIndex(size_t slotCount) {
+        slots.assign(slotCount, 0);
+        mask = slotCount - 1;
+        for (size_t i = 0; i < keyArray.size(); ++i) {
+            size_t slot = homeSlot(hashArray[i]);
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    /// <summary>
+    /// Освобождает ячейку индекса со сдвигом следующих назад (без "надгробий"), как в IntHashTable.
+    /// </summary>
+    void eraseSlot(size_t hole) {
+        size_t next = hole;
+        while (true) {
+            next = (next + 1) & mask;
+            if (slots[next] == 0) {
+                break;
+            }
+            size_t home = homeSlot(hashArray[slots[next] - 1]);
+            bool stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+            if (!stays) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = 0;
+    }
+
+    /// <summary>
+    /// Добавляет новую пару (ключа точно нет).
+    /// </summary>
+    size_t append(const Key& key, size_t hash, const Value& value) {
+        if ((keyArray.size() + 1) * 10 > slots.size() * 7) {
+            rebuildIndex(slots.size() * 2);
+        }
+        size_t slot = homeSlot(hash);
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        keyArray.push_back(key);
+        hashArray.push_back(hash);
+        valueArray.push_back(value);
+        slots[slot] = static_cast<uint32_t>(keyArray.size());
+        return keyArray.size() - 1;
+    }
+
+public:
+    /// <summary>
+    /// Конструктор словаря.
+    /// </summary>
+    /// <param name="capacity">Ожидаемое количество пар.</param>
+    SoADictionary(size_t capacity = 0) : mask(0) {
+        size_t slotCount = 16;
+        while (capacity * 10 > slotCount * 7) {
+            slotCount <<= 1;
+        }
+        rebuildIndex(slotCount);
+    }
+
+    /// <summary>
+    /// Вставка пары или обновление значения существующего ключа.
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    void put(const Key& key, const Value& value) {
+        size_t hash = fnv1aHash<Key>(key);
+        size_t slot = findSlot(key, hash);
+        if (slot != slots.size()) {
+            valueArray[slots[slot] - 1] = value;
+            return;
+        }
+        append(key, hash, value);
+    }
+
+    /// <summary>
+    /// Доступ к значению по ключу; если ключа нет, вставляется ноль.
+    /// Ссылка действительна до следующей вставки или удаления.
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    Value& operator[](const Key& key) {
+        size_t hash = fnv1aHash<Key>(key);
+        size_t slot = findSlot(key, hash);
+        if (slot != slots.size()) {
+            return valueArray[slots[slot] - 1];
+        }
+        return valueArray[append(key, hash, Value())];
+    }
+
+    /// <summary>
+    /// Получение значения по ключу.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    Value get(const Key& key) const {
+        size_t slot = findSlot(key, fnv1aHash<Key>(key));
+        if (slot == slots.size()) {
+            throw std::runtime_error("Key not found");
+        }
+        return valueArray[slots[slot] - 1];
+    }
+
+    Value* find(const Key& key) {
+        size_t slot = findSlot(key, fnv1aHash<Key>(key));
+        return slot == slots.size() ? nullptr : &valueArray[slots[slot] - 1];
+    }
+
+    const Value* find(const Key& key) const {
+        size_t slot = findSlot(key, fnv1aHash<Key>(key));
+        return slot == slots.size() ? nullptr : &valueArray[slots[slot] - 1];
+    }
+
+    bool contains(const Key& key) const {
+        return findSlot(key, fnv1aHash<Key>(key)) != slots.size();
+    }
+
+    /// <summary>
+    /// Удаление пары по ключу: на её место переносится последняя пара.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <BigO>Среднее : O(1)</BigO>
+    void remove(const Key& key) {
+        size_t slot = findSlot(key, fnv1aHash<Key>(key));
+        if (slot == slots.size()) {
+            throw std::runtime_error("Key not found");
+        }
+        size_t position = slots[slot] - 1;
+        eraseSlot(slot);
+
+        size_t last = keyArray.size() - 1;
+        if (position != last) {
+            slots[slotOf(last)] = static_cast<uint32_t>(position + 1);
+            keyArray[position] = std::move(keyArray[last]);
+            hashArray[position] = hashArray[last];
+            valueArray[position] = valueArray[last];
+        }
+        keyArray.pop_back();
+        hashArray.pop_back();
+        valueArray.pop_back();
+    }
+
+    size_t size() const {
+        return keyArray.size();
+    }
+
+    void clear() {
+        keyArray.clear();
+        hashArray.clear();
+        valueArray.clear();
+        rebuildIndex(16);
+    }
+
+    /// <summary>
+    /// Резервирует место под n пар без перестроек индекса и массивов.
+    /// </summary>
+    void reserve(size_t n) {
+        keyArray.reserve(n);
+        hashArray.reserve(n);
+        valueArray.reserve(n);
+        size_t slotCount = slots.size();
+        while (n * 10 > slotCount * 7) {
+            slotCount <<= 1;
+        }
+        if (slotCount != slots.size()) {
+            rebuildIndex(slotCount);
+        }
+    }
+
+    /// <summary>
+    /// Ключи; keys()[i] соответствует values()[i].
+    /// </summary>
+    const std::vector<Key>& keys() const {
+        return keyArray;
+    }
+
+    /// <summary>
+    /// Непрерывный массив значений для сканирующих вычислений.
+    /// </summary>
+    const std::vector<Value>& values() const {
+        return valueArray;
+    }
+
+    /// <summary>
+    /// Изменяемый доступ к массиву значений (например, для масштабирования всех счётчиков).
+    /// Набор и порядок пар через него не меняются.
+    /// </summary>
+    Value* valueData() {
+        return valueArray.data();
+    }
+
+    /// <summary>
+    /// Сумма всех значений. Четыре независимых аккумулятора убирают зависимость
+    /// между итерациями, в том числе для чисел с плавающей точкой.
+    /// </summary>
+    /// <BigO>O(n)</BigO>
+    Value sum() const {
+        const Value* data = valueArray.data();
+        size_t count = valueArray.size();
+        Value partial[4] = { Value(), Value(), Value(), Value() };
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            partial[0] += data[i];
+            partial[1] += data[i + 1];
+            partial[2] += data[i + 2];
+            partial[3] += data[i + 3];
+        }
+        for (; i < count; ++i) {
+            partial[0] += data[i];
+        }
+        return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    }
+
+    /// <summary>
+    /// Количество значений строго больше порога (без ветвлений).
+    /// </summary>
+    /// <BigO>O(n)</BigO>
+    size_t countAbove(Value threshold) const {
+        const Value* data = valueArray.data();
+        size_t count = valueArray.size();
+        size_t result = 0;
+        for (size_t i = 0; i < count; ++i) {
+            result += static_cast<size_t>(data[i] > threshold);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Номер пары с наибольшим значением (первой из равных).
+    /// Если словарь пуст, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    /// <BigO>O(n)</BigO>
+    size_t argmax() const {
+        if (valueArray.empty()) {
+            throw std::runtime_error("Dictionary is empty");
+        }
+        return static_cast<size_t>(std::max_element(valueArray.begin(), valueArray.end()) - valueArray.begin());
+    }
+
+    /// <summary>
+    /// n пар с наибольшими значениями по убыванию значения.
+    /// </summary>
+    /// <BigO>O(size + n log n)</BigO>
+    std::vector<std::pair<Key, Value>> topN(size_t n) const {
+        n = std::min(n, valueArray.size());
+        std::vector<uint32_t> order(valueArray.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        auto greater = [this](uint32_t a, uint32_t b) {
+            return valueArray[a] > valueArray[b] || (valueArray[a] == valueArray[b] && a < b);
+        };
+        std::nth_element(order.begin(), order.begin() + n, order.end(), greater);
+        std::sort(order.begin(), order.begin() + n, greater);
+
+        std::vector<std::pair<Key, Value>> result;
+        result.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            result.emplace_back(keyArray[order[i]], valueArray[order[i]]);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Функция для тестирования SoADictionary
+    /// </summary>
+    static void testSoADictionary() {
+        SoADictionary<std::string, int> counts;
+        counts.put("apple", 3);
+        counts.put("banana", 7);
+        counts["orange"] += 5;
+        counts["apple"] += 1;
+        assert(counts.size() == 3);
+        assert(counts.get("apple") == 4);
+        assert(counts.sum() == 16);
+        assert(counts.countAbove(4) == 2);
+        assert(counts.keys()[counts.argmax()] == "banana");
+        try {
+            counts.get("grape");
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        auto top = counts.topN(2);
+        assert(top.size() == 2);
+        assert(top[0].first == "banana" && top[1].first == "orange");
+
+        counts.remove("banana");
+        assert(!counts.contains("banana"));
+        assert(counts.size() == 3 - 1);
+        assert(counts.sum() == 9);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            assert(counts.get(counts.keys()[i]) == counts.values()[i]);
+        }
+
+        // Много пар: вставка, удаление каждого третьего, согласованность массивов и индекса
+        SoADictionary<int, double> big;
+        const int n = 30000;
+        for (int i = 0; i < n; ++i) {
+            big.put(i, 0.5);
+        }
+        assert(big.sum() == n * 0.5);
+        for (int i = 0; i < n; i += 3) {
+            big.remove(i);
+        }
+        for (int i = 0; i < n; ++i) {
+            assert(big.contains(i) == (i % 3 != 0));
+        }
+        for (size_t i = 0; i < big.size(); ++i) {
+            assert(big.get(big.keys()[i]) == big.values()[i]);
+        }
+        double* raw = big.valueData();
+        for (size_t i = 0; i < big.size(); ++i) {
+            raw[i] *= 2;
+        }
+        assert(big.sum() == static_cast<double>(big.size()));
+        assert(big.countAbove(0.5) == big.size());
+
+        std::cout << "All SOA DIC tests passed!" << std::endl;
+    }
+};
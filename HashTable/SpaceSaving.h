@@ -0,0 +1,278 @@
+﻿#pragma once
+#include <list>
+#include <vector>
+#include <iterator>
+#include <cstdint>
+#include <stdexcept>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "HashTable.h"
+
+/// <summary>
+/// Поиск частых элементов потока (heavy hitters) алгоритмом Space-Saving за фиксированную память.
+/// Отслеживается не больше capacity ключей. Новый ключ при заполнении занимает счётчик
+/// с минимальным значением min: его оценка становится min + вес, а погрешность - min.
+/// Гарантии (N - длина потока):
+/// - оценка count ключа не меньше истинной частоты, а count - error не больше её;
+/// - погрешность любого счётчика не превосходит N / capacity;
+/// - каждый ключ с частотой больше N / capacity отслеживается.
+/// Счётчики хранятся в stream-summary: список корзин с одинаковым значением по возрастанию,
+/// у каждой корзины - список её счётчиков. Увеличение на 1 переносит счётчик (splice)
+/// в соседнюю корзину, минимальный счётчик - в первой корзине, поэтому обновление стоит O(1).
+/// Поиск счётчика по ключу - через HashTable итераторов, как в LRUCache.
+/// </summary>
+/// <typeparam name="Key">Тип ключа</typeparam>
+template <typename Key>
+class SpaceSaving {
+public:
+    /// <summary>
+    /// Отслеживаемый ключ: оценка частоты и её максимальное завышение.
+    /// </summary>
+    struct Entry {
+        Key key;
+        uint64_t count; // Оценка частоты (не меньше истинной)
+        uint64_t error; // Истинная частота не меньше count - error
+    };
+
+private:
+    struct Bucket;
+    using BucketIterator = typename std::list<Bucket>::iterator;
+
+    struct Counter {
+        Key key;
+        uint64_t error;
+        BucketIterator bucket; // Корзина, хранящая значение счётчика
+    };
+
+    using CounterIterator = typename std::list<Counter>::iterator;
+
+    struct Bucket {
+        uint64_t count; // Общее значение счётчиков корзины
+        std::list<Counter> counters;
+    };
+
+    std::list<Bucket> buckets; // По возрастанию count, пустых корзин нет
+    HashTable<CounterIterator> lookup; // Поиск счётчика по ключу
+    size_t maxCounters; // Ёмкость
+    size_t counterCount; // Занято счётчиков
+    uint64_t streamLength; // Суммарный вес потока (N)
+
+    static size_t counterHash(const CounterIterator& counter) {
+        return fnv1aHash<Key>(counter->key);
+    }
+
+    const CounterIterator* findCounter(const Key& key, size_t hash) const {
+        return lookup.findByHash(hash, [&key](const CounterIterator& counter) {
+            return counter->key == key;
+        });
+    }
+
+    /// <summary>
+    /// Переносит счётчик в корзину со значением больше на weight.
+    /// BigO: O(1) при weight = 1 (следующая корзина либо подходит, либо новая вставляется перед ней),
+    /// иначе O(число пропускаемых корзин)
+    /// </summary>
+    void increment(CounterIterator counter, uint64_t weight) {
+        BucketIterator from = counter->bucket;
+        uint64_t target = from->count + weight;
+        BucketIterator to = std::next(from);
+        while (to != buckets.end() && to->count < target) {
+            ++to;
+        }
+        if (to == buckets.end() || to->count != target) {
+            to = buckets.insert(to, Bucket{ target, {} });
+        }
+        to->counters.splice(to->counters.end(), from->counters, counter);
+        counter->bucket = to;
+        if (from->counters.empty()) {
+            buckets.erase(from);
+        }
+    }
+
+public:
+    /// <summary>
+    /// Конструктор.
+    /// </summary>
+    /// <param name="capacity">Количество счётчиков (погрешность не больше N / capacity).</param>
+    explicit SpaceSaving(size_t capacity)
+        : lookup(counterHash, capacity), maxCounters(capacity), counterCount(0), streamLength(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpaceSaving capacity must be positive");
+        }
+    }
+
+    // Корзины и индекс хранят итераторы друг друга, поэтому объект не копируется
+    SpaceSaving(const SpaceSaving&) = delete;
+    SpaceSaving& operator=(const SpaceSaving&) = delete;
+
+    /// <summary>
+    /// Учитывает появление ключа в потоке.
+    /// </summary>
+    /// <param name="key">Ключ</param>
+    /// <param name="weight">Вес появления (число повторов)</param>
+    /// <BigO>Среднее : O(1) при weight = 1</BigO>
+    void add(const Key& key, uint64_t weight = 1) {
+        if (weight == 0) {
+            return;
+        }
+        streamLength += weight;
+        size_t hash = fnv1aHash<Key>(key);
+        const CounterIterator* found = findCounter(key, hash);
+        if (found != nullptr) {
+            increment(*found, weight);
+            return;
+        }
+
+        CounterIterator counter;
+        if (counterCount < maxCounters) {
+            // Новый счётчик начинает с нулевой корзины, которая сразу исчезнет в increment
+            buckets.push_front(Bucket{ 0, {} });
+            counter = buckets.front().counters.insert(buckets.front().counters.end(), Counter{ key, 0, buckets.begin() });
+            counterCount++;
+        }
+        else {
+            // Вытесняется самый давний из минимальных счётчиков
+            BucketIterator minimum = buckets.begin();
+            counter = minimum->counters.begin();
+            lookup.removeByHash(counterHash(counter), [&counter](const CounterIterator& candidate) {
+                return candidate == counter;
+            });
+            counter->key = key;
+            counter->error = minimum->count;
+        }
+        lookup.insertByHash(hash, CounterIterator(counter));
+        increment(counter, weight);
+    }
+
+    /// <summary>
+    /// Оценка частоты ключа сверху: значение его счётчика, а для неотслеживаемого ключа -
+    /// минимальное значение счётчиков (0, пока свободные счётчики есть).
+    /// </summary>
+    uint64_t estimate(const Key& key) const {
+        const CounterIterator* found = findCounter(key, fnv1aHash<Key>(key));
+        if (found != nullptr) {
+            return (*found)->bucket->count;
+        }
+        return counterCount < maxCounters ? 0 : minCount();
+    }
+
+    /// <summary>
+    /// Отслеживается ли ключ.
+    /// </summary>
+    bool contains(const Key& key) const {
+        return findCounter(key, fnv1aHash<Key>(key)) != nullptr;
+    }
+
+    /// <summary>
+    /// Минимальное значение счётчиков (0, если счётчиков нет).
+    /// </summary>
+    uint64_t minCount() const {
+        return buckets.empty() ? 0 : buckets.front().count;
+    }
+
+    /// <summary>
+    /// Обходит отслеживаемые ключи от большей оценки к меньшей: visit(key, count, error).
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (auto bucket = buckets.rbegin(); bucket != buckets.rend(); ++bucket) {
+            for (const Counter& counter : bucket->counters) {
+                visit(counter.key, bucket->count, counter.error);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Отслеживаемые ключи по убыванию оценки.
+    /// </summary>
+    std::vector<Entry> entries() const {
+        std::vector<Entry> result;
+        result.reserve(counterCount);
+        forEach([&result](const Key& key, uint64_t count, uint64_t error) {
+            result.push_back(Entry{ key, count, error });
+        });
+        return result;
+    }
+
+    /// <summary>
+    /// Количество отслеживаемых ключей.
+    /// </summary>
+    size_t size() const {
+        return counterCount;
+    }
+
+    size_t capacity() const {
+        return maxCounters;
+    }
+
+    /// <summary>
+    /// Суммарный вес обработанного потока (N).
+    /// </summary>
+    uint64_t total() const {
+        return streamLength;
+    }
+
+    /// <summary>
+    /// Функция для тестирования SpaceSaving
+    /// </summary>
+    static void testSpaceSaving() {
+        // Пока различных ключей не больше ёмкости, подсчёт точный
+        SpaceSaving<std::string> words(3);
+        for (const char* word : { "a", "b", "a", "c", "a", "b" }) {
+            words.add(word);
+        }
+        assert(words.size() == 3 && words.total() == 6);
+        assert(words.estimate("a") == 3 && words.estimate("b") == 2 && words.estimate("c") == 1);
+        std::vector<SpaceSaving<std::string>::Entry> exact = words.entries();
+        assert(exact[0].key == "a" && exact[1].key == "b" && exact[2].key == "c");
+        assert(exact[0].error == 0 && exact[2].error == 0);
+
+        // Новый ключ занимает минимальный счётчик
+        words.add("d");
+        assert(!words.contains("c") && words.contains("d"));
+        assert(words.estimate("d") == 2 && words.entries()[2].error == 1);
+        assert(words.estimate("c") == 2 && words.minCount() == 2); // Оценка сверху для вытесненного ключа
+        words.add("a", 5);
+        assert(words.estimate("a") == 8 && words.entries()[0].key == "a" && words.total() == 12);
+
+        // Гарантии на скошенном потоке
+        const size_t capacity = 50;
+        SpaceSaving<int> stream(capacity);
+        std::vector<uint64_t> truth(1000, 0);
+        uint64_t state = 12345;
+        for (int i = 0; i < 100000; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            double u = static_cast<double>(state >> 11) / 9007199254740992.0;
+            int key = static_cast<int>(1000 * u * u * u); // Малые ключи много чаще
+            truth[key]++;
+            stream.add(key);
+        }
+        assert(stream.size() == capacity && stream.total() == 100000);
+        uint64_t sum = 0;
+        uint64_t previous = UINT64_MAX;
+        stream.forEach([&](const int& key, uint64_t count, uint64_t error) {
+            assert(count <= previous);
+            assert(count - error <= truth[key] && truth[key] <= count);
+            assert(error <= stream.total() / capacity);
+            previous = count;
+            sum += count;
+        });
+        assert(sum == stream.total()); // Счётчики Space-Saving в сумме дают длину потока
+        for (int key = 0; key < 1000; ++key) {
+            if (truth[key] > stream.total() / capacity) {
+                assert(stream.contains(key));
+            }
+            assert(stream.estimate(key) >= truth[key]);
+        }
+
+        try {
+            SpaceSaving<int> empty(0);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+
+        std::cout << "All SPACE SAVING tests passed!" << std::endl;
+    }
+};
@@ -0,0 +1,319 @@
+﻿#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <cassert>
+#include <iostream>
+#include "HashTable.h"
+#include "Set.h"
+#include "IntHashTable.h"
+#include "Dictionary.h"
+
+/// <summary>
+/// Пул интернированных строк: каждая различная строка хранится один раз и получает
+/// плотный 32-битный идентификатор (0, 1, 2, ... в порядке первого появления).
+/// Символы лежат подряд в больших блоках-арене (без отдельного выделения памяти на строку),
+/// блоки не перемещаются, поэтому string_view, выданные view(), остаются действительными
+/// всё время жизни пула. Повторы находятся через HashTable идентификаторов с поиском по хешу
+/// строки (findByHash), так что повторная строка стоит 4 байта идентификатора, а сравнение
+/// интернированных строк - сравнение чисел.
+/// </summary>
+/// <typeparam name="CharT">Тип символа (char, wchar_t)</typeparam>
+template <typename CharT>
+class BasicStringPool {
+public:
+    using View = std::basic_string_view<CharT>;
+    static constexpr uint32_t npos = 0xFFFFFFFF; // "Строки нет в пуле"
+
+private:
+    static const size_t chunkSize = 64 * 1024; // Символов в обычном блоке арены
+
+    std::vector<std::unique_ptr<CharT[]>> chunks; // Блоки арены
+    std::vector<std::unique_ptr<CharT[]>> largeBlocks; // Отдельные блоки строк длиннее chunkSize
+    size_t chunkUsed; // Занято символов в последнем обычном блоке
+    size_t charCount; // Всего символов в пуле
+    std::vector<View> views; // Строка по идентификатору
+    std::vector<size_t> hashes; // Хеш строки по идентификатору (для перестройки индекса)
+    HashTable<uint32_t> index; // Идентификаторы, хешируются по своим строкам
+
+    static size_t hashOf(View text) {
+        return std::hash<View>()(text);
+    }
+
+    /// <summary>
+    /// Копирует символы в арену. Строка длиннее блока получает собственный блок.
+    /// </summary>
+    const CharT* store(View text) {
+        if (text.size() > chunkSize) {
+            largeBlocks.emplace_back(new CharT[text.size()]);
+            std::copy(text.begin(), text.end(), largeBlocks.back().get());
+            return largeBlocks.back().get();
+        }
+        if (chunks.empty() || chunkUsed + text.size() > chunkSize) {
+            chunks.emplace_back(new CharT[chunkSize]);
+            chunkUsed = 0;
+        }
+        CharT* target = chunks.back().get() + chunkUsed;
+        std::copy(text.begin(), text.end(), target);
+        chunkUsed += text.size();
+        return target;
+    }
+
+public:
+    BasicStringPool(size_t capacity = 16)
+        : chunkUsed(0), charCount(0),
+        index([this](const uint32_t& id) { return hashes[id]; }, capacity) {}
+
+    // Хеш-функция индекса ссылается на этот объект, поэтому пул не копируется и не перемещается
+    BasicStringPool(const BasicStringPool&) = delete;
+    BasicStringPool& operator=(const BasicStringPool&) = delete;
+
+    /// <summary>
+    /// Возвращает идентификатор строки, добавляя её в пул при первом появлении.
+    /// </summary>
+    /// <BigO>Среднее : O(длина строки)</BigO>
+    uint32_t intern(View text) {
+        size_t hash = hashOf(text);
+        const uint32_t* existing = index.findByHash(hash, [this, text](const uint32_t& id) {
+            return views[id] == text;
+        });
+        if (existing != nullptr) {
+            return *existing;
+        }
+        if (views.size() >= npos) {
+            throw std::overflow_error("String pool is full");
+        }
+
+        uint32_t id = static_cast<uint32_t>(views.size());
+        views.emplace_back(text.empty() ? View() : View(store(text), text.size()));
+        hashes.push_back(hash);
+        charCount += text.size();
+        index.insertByHash(hash, uint32_t(id));
+        return id;
+    }
+
+    /// <summary>
+    /// Идентификатор строки без добавления.
+    /// </summary>
+    /// <returns>Идентификатор или npos, если строки нет в пуле.</returns>
+    uint32_t lookup(View text) const {
+        const uint32_t* existing = index.findByHash(hashOf(text), [this, text](const uint32_t& id) {
+            return views[id] == text;
+        });
+        return existing == nullptr ? npos : *existing;
+    }
+
+    /// <summary>
+    /// Строка по идентификатору (действительна, пока жив пул).
+    /// Если идентификатора нет, будет сгенерировано исключение out_of_range.
+    /// </summary>
+    View view(uint32_t id) const {
+        if (id >= views.size()) {
+            throw std::out_of_range("Unknown string id");
+        }
+        return views[id];
+    }
+
+    /// <summary>
+    /// Количество различных строк.
+    /// </summary>
+    size_t size() const {
+        return views.size();
+    }
+
+    /// <summary>
+    /// Суммарное количество символов в пуле.
+    /// </summary>
+    size_t characters() const {
+        return charCount;
+    }
+
+    /// <summary>
+    /// Функция для тестирования BasicStringPool
+    /// </summary>
+    static void testStringPool() {
+        BasicStringPool<char> pool;
+        uint32_t apple = pool.intern("apple");
+        uint32_t banana = pool.intern("banana");
+        assert(apple == 0 && banana == 1);
+        assert(pool.intern("apple") == apple);
+        assert(pool.intern(std::string("ban") + "ana") == banana);
+        assert(pool.view(banana) == "banana");
+        assert(pool.lookup("cherry") == npos);
+        assert(pool.size() == 2);
+        assert(pool.intern("") == 2 && pool.view(2).empty());
+
+        // Строки остаются на месте при росте пула
+        std::string_view first = pool.view(apple);
+        for (int i = 0; i < 50000; ++i) {
+            pool.intern("token" + std::to_string(i % 20000));
+        }
+        assert(pool.size() == 3 + 20000);
+        assert(first.data() == pool.view(apple).data() && first == "apple");
+        std::string longText(100000, 'x');
+        uint32_t longId = pool.intern(longText);
+        assert(pool.view(longId) == longText);
+        assert(pool.intern("after long") == longId + 1);
+        assert(pool.view(longId + 1) == "after long");
+        assert(pool.view(apple) == "apple");
+        try {
+            pool.view(1000000);
+            assert(false);
+        }
+        catch (const std::out_of_range&) {
+        }
+
+        // Широкие строки
+        BasicStringPool<wchar_t> wide;
+        assert(wide.intern(L"слово") == wide.intern(std::wstring(L"слово")));
+        assert(wide.view(0) == L"слово");
+
+        std::cout << "All STRING POOL tests passed!" << std::endl;
+    }
+};
+
+using StringPool = BasicStringPool<char>;
+using WStringPool = BasicStringPool<wchar_t>;
+
+/// <summary>
+/// Множество строк поверх плоского IntSet идентификаторов общего пула: хранит по 4 байта на строку
+/// в непрерывном массиве, сравнивает числа вместо строк.
+/// </summary>
+template <typename CharT = char>
+class InternedSet {
+private:
+    BasicStringPool<CharT>& pool; // Общий пул строк
+    IntSet<uint32_t> ids; // Идентификаторы строк множества
+
+public:
+    using View = typename BasicStringPool<CharT>::View;
+
+    explicit InternedSet(BasicStringPool<CharT>& pool) : pool(pool) {}
+
+    /// <returns>true, если строки ещё не было в множестве.</returns>
+    bool insert(View text) {
+        return ids.insert(pool.intern(text)).second;
+    }
+
+    bool contains(View text) const {
+        uint32_t id = pool.lookup(text);
+        return id != BasicStringPool<CharT>::npos && ids.contains(id);
+    }
+
+    bool containsId(uint32_t id) const {
+        return ids.contains(id);
+    }
+
+    size_t size() const {
+        return ids.size();
+    }
+
+    /// <summary>
+    /// Обходит строки множества (в порядке хеш-таблицы идентификаторов).
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        ids.forEach([this, &visit](const uint32_t& id) {
+            visit(pool.view(id));
+        });
+    }
+};
+
+/// <summary>
+/// Словарь со строковыми ключами поверх Dictionary идентификаторов общего пула.
+/// </summary>
+template <typename Value, typename CharT = char>
+class InternedDictionary {
+private:
+    BasicStringPool<CharT>& pool; // Общий пул строк
+    Dictionary<uint32_t, Value> values; // Значения по идентификаторам ключей
+
+public:
+    using View = typename BasicStringPool<CharT>::View;
+
+    explicit InternedDictionary(BasicStringPool<CharT>& pool) : pool(pool) {}
+
+    void put(View key, const Value& value) {
+        values.put(pool.intern(key), value);
+    }
+
+    /// <summary>
+    /// Доступ к значению по ключу; если ключа нет, вставляется значение по умолчанию.
+    /// </summary>
+    Value& operator[](View key) {
+        return values[pool.intern(key)];
+    }
+
+    /// <summary>
+    /// Доступ по уже известному идентификатору - без хеширования строки.
+    /// </summary>
+    Value& atId(uint32_t id) {
+        return values[id];
+    }
+
+    /// <summary>
+    /// Получение значения по ключу.
+    /// Если ключ не найден, будет сгенерировано исключение runtime_error.
+    /// </summary>
+    Value get(View key) const {
+        uint32_t id = pool.lookup(key);
+        if (id == BasicStringPool<CharT>::npos) {
+            throw std::runtime_error("Key not found");
+        }
+        return values.get(id);
+    }
+
+    bool contains(View key) const {
+        uint32_t id = pool.lookup(key);
+        return id != BasicStringPool<CharT>::npos && values.contains(id);
+    }
+
+    size_t size() const {
+        return values.size();
+    }
+
+    /// <summary>
+    /// Обходит пары (строка-ключ, значение).
+    /// </summary>
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        values.forEach([this, &visit](const std::pair<uint32_t, Value>& pair) {
+            visit(pool.view(pair.first), pair.second);
+        });
+    }
+
+    /// <summary>
+    /// Функция для тестирования InternedSet и InternedDictionary
+    /// </summary>
+    static void testInternedDictionary() {
+        StringPool pool;
+        // Адаптеры делят один пул
+        InternedSet<> seen(pool);
+        InternedDictionary<int> counts(pool);
+        for (const char* word : { "the", "cat", "the", "hat", "the" }) {
+            seen.insert(word);
+            counts[word]++;
+        }
+        assert(seen.size() == 3 && seen.contains("cat") && !seen.contains("dog"));
+        assert(counts.get("the") == 3 && counts.get("hat") == 1);
+        assert(!counts.contains("dog"));
+        try {
+            counts.get("dog");
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        int total = 0;
+        counts.forEach([&total](std::string_view, int value) {
+            total += value;
+        });
+        assert(total == 5);
+
+        std::cout << "All INTERNED DICTIONARY tests passed!" << std::endl;
+    }
+};
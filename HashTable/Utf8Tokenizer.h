@@ -0,0 +1,304 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cwchar>
+#include <cwctype>
+#include <cassert>
+#include <iostream>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UTF8_TOKENIZER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8_TOKENIZER_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// <summary>
+/// Номер младшего единичного бита ненулевого 32-битного слова.
+/// </summary>
+inline int countTrailingZeros32(uint32_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(word);
+#endif
+}
+
+/// <summary>
+/// Декодирует UTF-8 в wstring без локали. Некорректные последовательности заменяются на U+FFFD
+/// (это не буква, поэтому при нормализации такой символ отбрасывается).
+/// </summary>
+inline std::wstring decodeUtf8(std::string_view bytes) {
+    std::wstring result;
+    result.reserve(bytes.size());
+    size_t i = 0;
+    while (i < bytes.size()) {
+        unsigned char lead = static_cast<unsigned char>(bytes[i]);
+        if (lead < 0x80) {
+            result += static_cast<wchar_t>(lead);
+            i++;
+            continue;
+        }
+        int length = (lead >= 0xC2 && lead <= 0xDF) ? 2 : (lead >= 0xE0 && lead <= 0xEF) ? 3 : (lead >= 0xF0 && lead <= 0xF4) ? 4 : 0;
+        char32_t code = length == 2 ? (lead & 0x1F) : length == 3 ? (lead & 0x0F) : (lead & 0x07);
+        bool valid = length != 0 && i + length <= bytes.size();
+        for (int k = 1; valid && k < length; ++k) {
+            unsigned char next = static_cast<unsigned char>(bytes[i + k]);
+            valid = (next & 0xC0) == 0x80;
+            code = (code << 6) | (next & 0x3F);
+        }
+        // Отсекаем "длинные" формы, суррогаты и символы, не помещающиеся в wchar_t
+        valid = valid && !(length == 3 && code < 0x800) && !(length == 4 && code < 0x10000)
+            && !(code >= 0xD800 && code <= 0xDFFF) && code <= static_cast<char32_t>(WCHAR_MAX);
+        result += valid ? static_cast<wchar_t>(code) : static_cast<wchar_t>(0xFFFD);
+        i += valid ? length : 1;
+    }
+    return result;
+}
+
+/// <summary>
+/// Дописывает символ в конец строки в кодировке UTF-8.
+/// </summary>
+inline void appendUtf8(std::string& out, char32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    }
+    else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+/// <summary>
+/// Токенизатор UTF-8 текста для закона Ципфа с приведением к нижнему регистру.
+/// Делает то же, что zipfsLaw: токены разделяются пробельными символами, буквы приводятся
+/// к нижнему регистру, прочие символы отбрасываются, пустые токены пропускаются.
+/// Работает прямо с байтами UTF-8, без перекодирования в wstring и без локали:
+///  - границы токенов (ASCII-пробелы) ищутся блоками по 16 байт (SSE2) или 32 байта (AVX2);
+///  - ASCII и кириллица U+0400..U+045F (включая Ё/ё) нормализуются по таблицам:
+///    байт ASCII -> строчная буква или "отбросить", пара байтов D0/D1 xx -> строчная буква;
+///  - токены с другими не-ASCII символами (латиница с диакритикой, прочие алфавиты, не-ASCII
+///    пробелы) обрабатываются запасным путём через towlower/iswalpha/iswspace, как в zipfsLaw.
+/// Нормализованный токен собирается в буфере токенизатора, который переиспользуется, поэтому
+/// после разогрева память не выделяется. Токен передаётся как string_view (UTF-8) и действителен
+/// только до следующего вызова visit.
+/// </summary>
+class Utf8Tokenizer {
+private:
+    std::string scratch; // Буфер нормализованного токена
+    unsigned char asciiLower[128]; // Байт ASCII -> строчная буква или 0 (отбросить)
+    uint16_t cyrillicLower[128]; // (lead & 1) << 6 | (second & 0x3F) -> UTF-8 строчной буквы (два байта) или 0
+
+#if defined(UTF8_TOKENIZER_AVX2)
+    static const size_t blockSize = 32;
+
+    /// <summary>
+    /// Маска ASCII-пробелов в блоке: бит i - байт data[i] (пробел или \t \n \v \f \r).
+    /// </summary>
+    static uint32_t spaceMask(const char* data) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        __m256i blank = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+        __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(blank, control)));
+    }
+#elif defined(UTF8_TOKENIZER_SSE2)
+    static const size_t blockSize = 16;
+
+    static uint32_t spaceMask(const char* data) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i blank = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+        __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(blank, control)));
+    }
+#endif
+
+    /// <summary>
+    /// Позиция первого байта с position, для которого isAsciiSpace(byte) == wantSpace (или size).
+    /// </summary>
+    static size_t scan(const char* data, size_t size, size_t position, bool wantSpace) {
+#if defined(UTF8_TOKENIZER_AVX2) || defined(UTF8_TOKENIZER_SSE2)
+        const uint32_t full = blockSize == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+        while (position + blockSize <= size) {
+            uint32_t mask = spaceMask(data + position);
+            if (!wantSpace) {
+                mask = ~mask & full;
+            }
+            if (mask != 0) {
+                return position + countTrailingZeros32(mask);
+            }
+            position += blockSize;
+        }
+#endif
+        while (position < size && isAsciiSpace(static_cast<unsigned char>(data[position])) != wantSpace) {
+            position++;
+        }
+        return position;
+    }
+
+    /// <summary>
+    /// Запасной путь для токена с символами вне таблиц: как в zipfsLaw, через wchar_t и функции локали.
+    /// </summary>
+    template <typename Visitor>
+    void emitFallback(std::string_view token, Visitor& visit) {
+        scratch.clear();
+        for (wchar_t c : decodeUtf8(token)) {
+            if (iswspace(c)) {
+                if (!scratch.empty()) {
+                    visit(std::string_view(scratch));
+                    scratch.clear();
+                }
+                continue;
+            }
+            c = static_cast<wchar_t>(towlower(c));
+            if (iswalpha(c)) {
+                appendUtf8(scratch, static_cast<char32_t>(c));
+            }
+        }
+        if (!scratch.empty()) {
+            visit(std::string_view(scratch));
+        }
+    }
+
+    /// <summary>
+    /// Нормализует один токен (без ASCII-пробелов) по таблицам и передаёт его visit.
+    /// </summary>
+    template <typename Visitor>
+    void emit(std::string_view token, Visitor& visit) {
+        scratch.clear();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(token.data());
+        size_t length = token.size();
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char b = bytes[i];
+            if (b < 0x80) {
+                unsigned char lower = asciiLower[b];
+                if (lower != 0) {
+                    scratch += static_cast<char>(lower);
+                }
+                continue;
+            }
+            if ((b == 0xD0 || b == 0xD1) && i + 1 < length && (bytes[i + 1] & 0xC0) == 0x80) {
+                uint16_t lower = cyrillicLower[((b & 1) << 6) | (bytes[i + 1] & 0x3F)];
+                if (lower != 0) {
+                    scratch += static_cast<char>(lower >> 8);
+                    scratch += static_cast<char>(lower & 0xFF);
+                    i++;
+                    continue;
+                }
+            }
+            emitFallback(token, visit);
+            return;
+        }
+        if (!scratch.empty()) {
+            visit(std::string_view(scratch));
+        }
+    }
+
+public:
+    /// <summary>
+    /// Разделитель токенов: ASCII-пробел (пробел или \t \n \v \f \r). Тот же набор проверяют
+    /// SIMD-маски spaceMask. Кто режет текст на куски для токенизатора (потоки zipfsLawParallel,
+    /// блоки ZipfCounter), должен резать только по этим байтам.
+    /// </summary>
+    static bool isAsciiSpace(unsigned char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    Utf8Tokenizer() {
+        for (int c = 0; c < 128; ++c) {
+            asciiLower[c] = (c >= 'a' && c <= 'z') ? static_cast<unsigned char>(c)
+                : (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : 0;
+        }
+        // U+0400..U+047F: D0 80..BF и D1 80..BF. Буквы U+0400..U+045F приводятся к строчным,
+        // U+0460..U+047F (исторические буквы) уходят в запасной путь
+        for (int index = 0; index < 128; ++index) {
+            char32_t code = 0x400 + index;
+            char32_t lower = code <= 0x40F ? code + 0x50 : code <= 0x42F ? code + 0x20 : code <= 0x45F ? code : 0;
+            cyrillicLower[index] = lower == 0 ? 0
+                : static_cast<uint16_t>(((0xC0 | (lower >> 6)) << 8) | (0x80 | (lower & 0x3F)));
+        }
+        scratch.reserve(256);
+    }
+
+    /// <summary>
+    /// Разбивает UTF-8 текст на нормализованные токены.
+    /// </summary>
+    /// <param name="text">Текст в UTF-8.</param>
+    /// <param name="visit">Функция, вызываемая для каждого непустого нормализованного токена (std::string_view в UTF-8).</param>
+    /// <BigO>O(n)</BigO>
+    template <typename Visitor>
+    void tokenize(std::string_view text, Visitor visit) {
+        const char* data = text.data();
+        size_t size = text.size();
+        size_t position = 0;
+        while (true) {
+            position = scan(data, size, position, false);
+            if (position >= size) {
+                break;
+            }
+            size_t end = scan(data, size, position, true);
+            emit(std::string_view(data + position, end - position), visit);
+            position = end;
+        }
+    }
+
+    /// <summary>
+    /// Функция для тестирования Utf8Tokenizer
+    /// </summary>
+    static void testUtf8Tokenizer() {
+        Utf8Tokenizer tokenizer;
+        std::vector<std::string> tokens;
+        auto collect = [&tokens](std::string_view token) {
+            tokens.emplace_back(token);
+        };
+
+        tokenizer.tokenize("  Hello,   WORLD!\tdon't\n123 x1y  ", collect);
+        assert((tokens == std::vector<std::string>{ "hello", "world", "dont", "xy" }));
+
+        // Кириллица, включая Ё, и смешанный регистр
+        tokens.clear();
+        tokenizer.tokenize(u8"ПРИВЕТ, Мир! Ёлка ёЛКА \"Сталкер\"...", collect);
+        assert((tokens == std::vector<std::string>{ u8"привет", u8"мир", u8"ёлка", u8"ёлка", u8"сталкер" }));
+
+        // Длинный текст: границы токенов на стыках блоков
+        std::string longText;
+        for (int i = 0; i < 100; ++i) {
+            longText += (i % 3 == 0) ? "Abcdefghijklmnopqrstuvwxyz   " : u8"Тень\t\tЧернобыля ";
+        }
+        tokens.clear();
+        tokenizer.tokenize(longText, collect);
+        assert(tokens.size() == 34 + 66 * 2);
+        assert(tokens[0] == "abcdefghijklmnopqrstuvwxyz" && tokens[1] == u8"тень" && tokens[2] == u8"чернобыля");
+
+        // Некорректный UTF-8 не ломает разбор
+        tokens.clear();
+        tokenizer.tokenize(std::string("ab\xD0 cd\xFF" "ef"), collect);
+        assert((tokens == std::vector<std::string>{ "ab", "cdef" }));
+
+        tokens.clear();
+        tokenizer.tokenize("", collect);
+        tokenizer.tokenize(" \n\t ", collect);
+        assert(tokens.empty());
+
+        std::cout << "All UTF8 TOKENIZER tests passed!" << std::endl;
+    }
+};